@@ -0,0 +1,53 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+#include <oz/oz.h>
+
+static double bench_kernel(_nmod_vec_oz_ntt_func ntt, mp_srcptr a, mp_ptr t, mp_srcptr w, mp_srcptr w_pre,
+                           const long n, const nmod_t q, const long ntrials, mp_limb_t *r) {
+  uint64_t walltime = ggh_walltime(0);
+  for(long i=0; i<ntrials; i++) {
+    _nmod_vec_set(t, a, n);
+    ntt(t, w, w_pre, n, q);
+    *r ^= t[i%n];
+  }
+  return ggh_seconds(ggh_walltime(walltime))/ntrials;
+}
+
+int main(int argc, char *argv[]) {
+  const long ntrials = (argc>=2) ? atol(argv[1]) : 256;
+  const long log_n_min = (argc>=3) ? atol(argv[2]) : OZ_NMOD_NTT_MIN_LOG;
+  const long log_n_max = (argc>=4) ? atol(argv[3]) : OZ_NMOD_NTT_MAX_LOG;
+
+  flint_rand_t state;
+  flint_randinit(state);
+
+  for(long log_n=log_n_min; log_n<=log_n_max; log_n++) {
+    const long n = 1L<<log_n;
+    nmod_t q;
+    nmod_init(&q, _n_next_oz_good_probaprime((UWORD(1)<<(FLINT_BITS-3)) + 1, 2*n));
+
+    mp_ptr a = _nmod_vec_init(n);
+    mp_ptr t = _nmod_vec_init(n);
+    mp_ptr w = _nmod_vec_init(n);
+    mp_ptr w_pre = _nmod_vec_init(n);
+    _nmod_vec_randtest(a, state, n, q);
+    _nmod_vec_oz_set_powers_shoup(w, w_pre, n, _nmod_nth_root(2*n, q.n), q);
+
+    mp_limb_t r0 = 0, r1 = 0;
+    const double s0 = bench_kernel(_nmod_vec_oz_ntt_generic, a, t, w, w_pre, n, q, ntrials, &r0);
+    const double s1 = bench_kernel(_nmod_vec_oz_ntt_get_kernel(n), a, t, w, w_pre, n, q, ntrials, &r1);
+
+    printf("n: %6ld, generic: %8.3f µs, specialised: %8.3f µs, speedup: %5.2f %s\n",
+           n, 1e6*s0, 1e6*s1, s0/s1, (r0 == r1) ? "" : "MISMATCH");
+    fflush(0);
+
+    _nmod_vec_clear(w_pre);
+    _nmod_vec_clear(w);
+    _nmod_vec_clear(t);
+    _nmod_vec_clear(a);
+  }
+
+  flint_randclear(state);
+  flint_cleanup();
+  return 0;
+}
@@ -0,0 +1,38 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+#include <oz/oz.h>
+
+int main(int argc, char *argv[]) {
+  const long ntrials = (argc>=2) ? atol(argv[1]) : 64;
+  const long log_n_min = (argc>=3) ? atol(argv[2]) : 10;
+  const long log_n_max = (argc>=4) ? atol(argv[3]) : 16;
+
+  flint_rand_t state;
+  flint_randinit(state);
+
+  for(long log_n=log_n_min; log_n<=log_n_max; log_n++) {
+    const long n = 1L<<log_n;
+    const mp_limb_t p = _n_next_oz_good_probaprime((UWORD(1)<<(FLINT_BITS-3)) + 1, 2*n);
+
+    nmod_poly_t a;
+    nmod_poly_init(a, p);
+    nmod_poly_randtest(a, state, n);
+
+    mp_limb_t r = 0;
+    uint64_t t = ggh_walltime(0);
+    for(long i=0; i<ntrials; i++)
+      r ^= nmod_poly_oz_resultant(a, n);
+    t = ggh_walltime(t);
+
+    const double s = ggh_seconds(t)/ntrials;
+    printf("n: %6ld, log p: %2d, res: %7.3f ms, per n·log n: %6.2f ns (%016lx)\n",
+           n, (int)FLINT_BIT_COUNT(p), 1000*s, 1e9*s/(n*log_n), r);
+    fflush(0);
+
+    nmod_poly_clear(a);
+  }
+
+  flint_randclear(state);
+  flint_cleanup();
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+#include "common.h"
+
+#define DEFAULT_BATCH 256
+
+int main(int argc, char *argv[]) {
+
+  cmdline_params_t params;
+  const char *name = "GGHLite Encoding Server";
+  const char *extra = "SOCKET  path of Unix domain socket to listen on (after all options)";
+  parse_cmdline(params, argc, argv, name, extra);
+
+  if (optind >= argc)
+    print_help_and_exit(name, extra);
+  const char *path = argv[optind];
+
+  print_header(name, params);
+
+  aes_randstate_t randstate;
+  aes_randinit_seed(randstate, params->shaseed, NULL);
+
+  uint64_t t = ggh_walltime(0);
+  gghlite_sk_t self;
+  gghlite_init(self, params->lambda, params->kappa, params->gamma, params->rerand, params->flags, randstate);
+  gghlite_params_print(self->params);
+  printf("\n---\n");
+  printf("InstGen wall time: %8.2f s\n", ggh_seconds(ggh_walltime(t)));
+
+  /* clients zero-testing locally need the public parameters */
+  char *params_path = malloc(strlen(path) + sizeof(".params"));
+  sprintf(params_path, "%s.params", path);
+  FILE *fp = fopen(params_path, "wb");
+  if (fp == NULL || gghlite_params_fwrite(fp, self->params))
+    ggh_die("Cannot write public parameters to %s.", params_path);
+  fclose(fp);
+
+  printf("Serving on %s, public parameters in %s\n", path, params_path);
+  fflush(stdout);
+
+  int status = gghlite_server_run(self, path, DEFAULT_BATCH);
+  if (status)
+    fprintf(stderr, "Cannot serve on %s.\n", path);
+
+  unlink(params_path);
+  free(params_path);
+  gghlite_sk_clear(self, 1);
+  aes_randclear(randstate);
+  flint_cleanup();
+  mpfr_free_cache();
+  return status;
+}
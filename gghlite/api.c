@@ -1,5 +1,7 @@
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
+#include <openssl/evp.h>
 #include "gghlite.h"
 #include "gghlite-internals.h"
 
@@ -10,18 +12,21 @@ gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self)
     fmpz_mod_poly_init2(op, self->q, self->n);
 }
 
-void
-gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
-                            const gghlite_clr_t f, const size_t k, int *group,
-                            const int rerand)
+static void
+_gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
+                             const gghlite_clr_t f, const size_t k, int *group,
+                             const int rerand, aes_randstate_t rng)
 {
     fmpz_poly_t t_o; fmpz_poly_init(t_o);
-    const mp_bitcnt_t prec = (self->params->n/4 < 8192) ? 8192 : self->params->n/4;
     const oz_flag_t flags = (self->params->flags & GGHLITE_FLAGS_VERBOSE) ? OZ_VERBOSE : 0;
-    _fmpz_poly_oz_rem_small_iter(t_o, f, self->g, self->params->n, self->g_inv, prec, flags);
+    if (fmpz_poly_degree(f) == 0)
+        _fmpz_poly_oz_rem_small_iter_fmpz(t_o, f->coeffs, self->rem_ctx, flags);
+    else
+        _fmpz_poly_oz_rem_small_iter(t_o, f, self->g, self->params->n, self->g_inv,
+                                     _gghlite_rem_small_prec(self->params), flags);
 
     if (rerand)
-        dgsl_rot_mp_call_plus_fmpz_poly(t_o, self->D_g, t_o, self->rng);
+        dgsl_rot_mp_call_plus_fmpz_poly(t_o, self->D_g, t_o, rng);
 
     // encode at level zero
     fmpz_mod_poly_oz_ntt_enc_fmpz_poly(rop, t_o, self->params->ntt);
@@ -33,61 +38,450 @@ gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
         if(!gghlite_sk_is_symmetric(self) && (k>1))
             ggh_die("Raising to higher levels than 1 not supported. Instead, multiply by the right combination of y_i.");
 
-        for (unsigned int r = 0; r < self->params->gamma; r++) {
-            if (group[r]) {
-                if(gghlite_sk_is_symmetric(self)) {
-                    for(size_t j=0; j<k; j++) // divide by z_i^k
-                        fmpz_mod_poly_oz_ntt_mul(rop, rop, self->z_inv[r], self->params->n);
-                    break;
-                } else {
-                    fmpz_mod_poly_oz_ntt_mul(rop, rop, self->z_inv[r], self->params->n);
-                }
-            }
+        // divide by z_i^k for symmetric and by ∏ z_i over the group for asymmetric instances
+        _gghlite_sk_mul_z_inv(rop, self, gghlite_sk_is_symmetric(self) ? k : 1, group);
+    }
+}
+
+void
+gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
+                            const gghlite_clr_t f, const size_t k, int *group,
+                            const int rerand)
+{
+    _gghlite_enc_set_gghlite_clr(rop, self, f, k, group, rerand, (void*)self->rng);
+}
+
+void
+gghlite_enc_set_gghlite_clr_batch(gghlite_enc_t *rop, const gghlite_sk_t self,
+                                  gghlite_clr_t *f, const size_t len, const size_t *k, int **group,
+                                  const int rerand)
+{
+    if (len == 0)
+        return;
+
+    /* one draw from the shared stream, item i is re-randomised from AES(seed, i) */
+    size_t nbytes = 0;
+    unsigned char *seed = NULL;
+    if (rerand)
+        seed = random_aes((void*)self->rng, 128, &nbytes);
+
+    /* batches are usually at a single level: warm the z_i^{-1} cache for it before the workers race for it */
+    for(size_t i=0; i<len; i++) {
+        if (k[i] == 0)
+            continue;
+        gghlite_enc_t t;
+        gghlite_enc_init(t, self->params);
+        fmpz_mod_poly_oz_ntt_set_ui(t, 1, self->params->n);
+        _gghlite_sk_mul_z_inv(t, self, gghlite_sk_is_symmetric(self) ? k[i] : 1, group[i]);
+        gghlite_enc_clear(t);
+        break;
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i=0; i<len; i++) {
+        if (rerand) {
+            uint64_t idx = i;
+            aes_randstate_t rng;
+            aes_randinit_seedn(rng, (char *)seed, nbytes, (char *)&idx, sizeof(idx));
+            _gghlite_enc_set_gghlite_clr(rop[i], self, f[i], k[i], group[i], 1, rng);
+            aes_randclear(rng);
+        } else {
+            _gghlite_enc_set_gghlite_clr(rop[i], self, f[i], k[i], group[i], 0, NULL);
         }
     }
+
+    free(seed);
+}
+
+void
+gghlite_enc_rerand(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                   const size_t k, const size_t i, aes_randstate_t randstate)
+{
+    assert(k >= 1);
+    if (k > self->kappa || !self->x || !gghlite_params_have_rerand(self, k-1))
+        ggh_die("No re-randomisers available for level %zu.", k);
+
+    gghlite_enc_t *x = self->x[gghlite_params_is_symmetric(self) ? 0 : i][k-1];
+    const size_t m = self->x_len;
+    const size_t t = (GGHLITE_RERAND_SUBSET_SIZE < m) ? GGHLITE_RERAND_SUBSET_SIZE : m;
+
+    /* random t-subset of the pool by a partial Fisher-Yates shuffle */
+    size_t idx[m];
+    for(size_t j=0; j<m; j++)
+        idx[j] = j;
+
+    fmpz_t r, b;
+    fmpz_init(r);
+    fmpz_init(b);
+    for(size_t j=0; j<t; j++) {
+        fmpz_set_ui(b, m - j);
+        fmpz_randm_aes(r, randstate, b);
+        const size_t s = j + fmpz_get_ui(r);
+        const size_t tmp = idx[j]; idx[j] = idx[s]; idx[s] = tmp;
+    }
+    fmpz_clear(b);
+    fmpz_clear(r);
+
+    /* ρ_j ← D_{ℤ^n,σ^*_k} */
+    dgsl_rot_mp_t *D = self->D_sigma_s[k-1];
+
+    gghlite_enc_t rho[t], xs[t];
+    fmpz_poly_t rho_j;
+    fmpz_poly_init(rho_j);
+    for(size_t j=0; j<t; j++) {
+        fmpz_poly_sample_D(rho_j, D, randstate);
+        gghlite_enc_init(rho[j], self);
+        fmpz_mod_poly_oz_ntt_enc_fmpz_poly(rho[j], rho_j, self->ntt);
+        /* shallow copy, the pool is only read */
+        xs[j][0] = x[idx[j]][0];
+    }
+    fmpz_poly_clear(rho_j);
+
+    /* rop = op + Σ ρ_j·x_j */
+    gghlite_enc_t e;
+    gghlite_enc_init(e, self);
+    gghlite_enc_inner_product(e, self, rho, xs, t);
+    gghlite_enc_add(rop, self, op, e);
+    gghlite_enc_clear(e);
+
+    for(size_t j=0; j<t; j++)
+        gghlite_enc_clear(rho[j]);
+}
+
+void
+gghlite_enc_acc_init(gghlite_enc_acc_t op, const gghlite_params_t self)
+{
+    op->n = self->n;
+    op->slots = _fmpz_vec_init(self->n);
+    op->bound = 0;
+}
+
+void
+gghlite_enc_acc_clear(gghlite_enc_acc_t op)
+{
+    _fmpz_vec_clear(op->slots, op->n);
+    op->slots = NULL;
+}
+
+void
+gghlite_enc_acc_reduce(gghlite_enc_acc_t op, const gghlite_params_t self)
+{
+    if (op->bound > 1) {
+        _fmpz_vec_scalar_mod_fmpz(op->slots, op->slots, op->n, self->q);
+        op->bound = 1;
+    } else if (op->bound == 1) {
+        /* slots in (-q,q), only negative slots need fixing */
+        for(size_t i=0; i<op->n; i++)
+            if (fmpz_sgn(op->slots + i) < 0)
+                fmpz_add(op->slots + i, op->slots + i, self->q);
+    }
+}
+
+/**
+   Make room for adding something bounded by `bound`·q to `op`.
+*/
+
+static inline void
+_gghlite_enc_acc_fit_bound(gghlite_enc_acc_t op, const gghlite_params_t self, const size_t bound)
+{
+    if (op->bound + bound > GGHLITE_ENC_ACC_MAX_BOUND)
+        gghlite_enc_acc_reduce(op, self);
+    op->bound += bound;
+}
+
+void
+gghlite_enc_acc_set_gghlite_enc(gghlite_enc_acc_t rop, const gghlite_params_t self, const gghlite_enc_t f)
+{
+    (void) self;
+    const size_t len = fmpz_mod_poly_length(f);
+    _fmpz_vec_set(rop->slots, f->coeffs, len);
+    _fmpz_vec_zero(rop->slots + len, rop->n - len);
+    rop->bound = 1;
+}
+
+void
+gghlite_enc_acc_add(gghlite_enc_acc_t h, const gghlite_params_t self, const gghlite_enc_t f)
+{
+    _gghlite_enc_acc_fit_bound(h, self, 1);
+    _fmpz_vec_add(h->slots, h->slots, f->coeffs, fmpz_mod_poly_length(f));
+}
+
+void
+gghlite_enc_acc_sub(gghlite_enc_acc_t h, const gghlite_params_t self, const gghlite_enc_t f)
+{
+    _gghlite_enc_acc_fit_bound(h, self, 1);
+    _fmpz_vec_sub(h->slots, h->slots, f->coeffs, fmpz_mod_poly_length(f));
+}
+
+void
+gghlite_enc_acc_add_acc(gghlite_enc_acc_t h, const gghlite_params_t self, const gghlite_enc_acc_t f)
+{
+    assert(h != f);
+    _gghlite_enc_acc_fit_bound(h, self, f->bound);
+    _fmpz_vec_add(h->slots, h->slots, f->slots, h->n);
+    /* f itself might be at the maximum bound, then reducing h beforehand was not enough */
+    if (h->bound > GGHLITE_ENC_ACC_MAX_BOUND)
+        gghlite_enc_acc_reduce(h, self);
+}
+
+void
+gghlite_enc_set_gghlite_enc_acc(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_acc_t op)
+{
+    fmpz_mod_poly_fit_length(rop, op->n);
+    if (op->bound > 1)
+        _fmpz_vec_scalar_mod_fmpz(rop->coeffs, op->slots, op->n, self->q);
+    else {
+        for(size_t i=0; i<op->n; i++) {
+            if (fmpz_sgn(op->slots + i) < 0)
+                fmpz_add(rop->coeffs + i, op->slots + i, self->q);
+            else
+                fmpz_set(rop->coeffs + i, op->slots + i);
+        }
+    }
+    _fmpz_mod_poly_set_length(rop, op->n);
+    _fmpz_mod_poly_normalise(rop);
+}
+
+/**
+   Zero-test `op` using scratch space `t`, `c` and `acc`, `q2` must hold $\\lfloor q/2 \\rfloor$.
+   The number of coefficients inspected is written to `scanned`.
+*/
+
+static int
+_gghlite_enc_is_zero(const gghlite_params_t self, const fmpz_mod_poly_t op, gghlite_enc_t t,
+                     fmpz_t c, fmpz_t acc, const fmpz_t q2, size_t *scanned)
+{
+    int r = 1;
+    long i;
+
+    _fmpz_mod_poly_oz_ntt_mul(t, self->pzt, op, self->ntt);
+    fmpz_mod_poly_oz_ntt_dec(t, t, self->ntt);
+
+    fmpz_zero(acc);
+
+    /* |c| ≥ 2^{bits(c)-1}, so c^2 exceeds the bound if 2·bits(c) - 2 ≥ bits(bound) */
+    const mp_bitcnt_t bound_bits = fmpz_bits(self->zero_bound);
+
+    for(i=0; i<t->length; i++) {
+        /* centred representative, we only need |c| */
+        if (fmpz_cmp(t->coeffs + i, q2) >= 0)
+            fmpz_sub(c, self->q, t->coeffs + i);
+        else
+            fmpz_set(c, t->coeffs + i);
+
+        if (2*fmpz_bits(c) >= bound_bits + 2) {
+            r = 0;
+            break;
+        }
+        fmpz_addmul(acc, c, c);
+        if (fmpz_cmp(acc, self->zero_bound) > 0) {
+            r = 0;
+            break;
+        }
+    }
+
+    if (scanned)
+        *scanned = (r) ? (size_t)t->length : (size_t)(i + 1);
+    return r;
 }
 
 int
 gghlite_enc_is_zero(const gghlite_params_t self, const fmpz_mod_poly_t op)
 {
-    gghlite_clr_t t;
-    mpfr_t norm, bound;
+    gghlite_enc_t t;
+    fmpz_t c, q2, acc;
     int r;
 
-    gghlite_clr_init(t);
-    _gghlite_enc_extract_raw(t, self, op);
+    gghlite_enc_init(t, self);
+    fmpz_init(c);
+    fmpz_init(acc);
+    fmpz_init(q2);
+    fmpz_fdiv_q_2exp(q2, self->q, 1);
 
-    mpfr_init2(norm, _gghlite_prec(self));
-    mpfr_init2(bound, _gghlite_prec(self));
-    fmpz_poly_2norm_mpfr(norm, t, MPFR_RNDN);
+    r = _gghlite_enc_is_zero(self, op, t, c, acc, q2, NULL);
 
-    {
-        /* Set bound = q */
-        mpz_t q_z;
-        mpz_init(q_z);
-        fmpz_get_mpz(q_z, self->q);
-        mpfr_set_z(bound, q_z, MPFR_RNDN);
-        mpz_clear(q_z);
-    }
+    fmpz_clear(q2);
+    fmpz_clear(acc);
+    fmpz_clear(c);
+    gghlite_enc_clear(t);
+    return r;
+}
 
+void
+gghlite_enc_is_zero_batch(uint64_t *rop, size_t *scanned, const gghlite_params_t self,
+                          gghlite_enc_t *op, const size_t len)
+{
+    fmpz_t q2;
+    fmpz_init(q2);
+    fmpz_fdiv_q_2exp(q2, self->q, 1);
+
+    memset(rop, 0, ((len + 63)/64) * sizeof(uint64_t));
+
+#pragma omp parallel if (len > 1)
     {
-        /* compute q^{1-xi} */
-        mpfr_t ex;
-        mpfr_init2(ex, _gghlite_prec(self));
-        mpfr_set_ui(ex, 1, MPFR_RNDN);
-        mpfr_sub(ex, ex, self->xi, MPFR_RNDN);
-        mpfr_pow(bound, bound, ex, MPFR_RNDN);
-        mpfr_clear(ex);
+        /* scratch space is allocated once per thread, not once per item */
+        gghlite_enc_t t;
+        fmpz_t c, acc;
+        gghlite_enc_init(t, self);
+        fmpz_init(c);
+        fmpz_init(acc);
+
+#pragma omp for schedule(dynamic)
+        for(size_t i=0; i<len; i++) {
+            if (_gghlite_enc_is_zero(self, op[i], t, c, acc, q2, (scanned) ? scanned + i : NULL)) {
+#pragma omp atomic
+                rop[i/64] |= ((uint64_t)1)<<(i%64);
+            }
+        }
+
+        fmpz_clear(acc);
+        fmpz_clear(c);
+        gghlite_enc_clear(t);
     }
 
-    r = mpfr_cmp(norm, bound);
+    fmpz_clear(q2);
+}
+
+/**
+   Set `tmp` to $[p_{zt}·f]_q$ in the coefficient domain, return shift for extracting the $ℓ$ most
+   significant bits.
+*/
+
+static mp_bitcnt_t
+_gghlite_enc_extract_prepare(gghlite_enc_t tmp, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    _fmpz_mod_poly_oz_ntt_mul(tmp, self->pzt, op, self->ntt);
+    fmpz_mod_poly_oz_ntt_dec(tmp, tmp, self->ntt);
+    return fmpz_sizeinbase(self->q, 2) - self->ell;
+}
 
-    mpfr_clear(bound);
-    mpfr_clear(norm);
-    gghlite_clr_clear(t);
+/**
+   Set `rop` to the $ℓ$ most significant bits of the centred representative of `op`, rounding
+   towards zero so that encodings of zero extract to zero.
+*/
 
-    if (r <= 0)
-        return 1;
+static inline void
+_gghlite_enc_extract_coeff(fmpz_t rop, const fmpz_t op, const fmpz_t q, const fmpz_t q2,
+                           const mp_bitcnt_t shift)
+{
+    if (fmpz_cmp(op, q2) >= 0)
+        fmpz_sub(rop, op, q);
     else
-        return 0;
+        fmpz_set(rop, op);
+    fmpz_tdiv_q_2exp(rop, rop, shift);
+}
+
+void
+gghlite_enc_extract(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    gghlite_enc_t t;
+    fmpz_t q2;
+
+    gghlite_enc_init(t, self);
+    fmpz_init(q2);
+    fmpz_fdiv_q_2exp(q2, self->q, 1);
+
+    const mp_bitcnt_t shift = _gghlite_enc_extract_prepare(t, self, op);
+
+    fmpz_poly_fit_length(rop, t->length);
+    for(long i=0; i<t->length; i++)
+        _gghlite_enc_extract_coeff(rop->coeffs + i, t->coeffs + i, self->q, q2, shift);
+    _fmpz_poly_set_length(rop, t->length);
+    _fmpz_poly_normalise(rop);
+
+    fmpz_clear(q2);
+    gghlite_enc_clear(t);
+}
+
+void
+gghlite_enc_extract_key(unsigned char *key, const gghlite_params_t self, const gghlite_enc_t op,
+                        gghlite_enc_t tmp)
+{
+    gghlite_enc_t t_;
+    fmpz_mod_poly_struct *t = tmp;
+    if (!tmp) {
+        gghlite_enc_init(t_, self);
+        t = t_;
+    }
+
+    fmpz_t c, q2;
+    fmpz_init(c);
+    fmpz_init(q2);
+    fmpz_fdiv_q_2exp(q2, self->q, 1);
+
+    const mp_bitcnt_t shift = _gghlite_enc_extract_prepare(t, self, op);
+
+    EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+    if (ctx == NULL || EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) != 1)
+        ggh_die("Cannot initialise SHA-256.");
+
+    /* each coefficient is hashed as a 64-bit little-endian two's complement integer */
+    unsigned char buf[8];
+    for(long i=0; i<self->n; i++) {
+        if (i < t->length)
+            _gghlite_enc_extract_coeff(c, t->coeffs + i, self->q, q2, shift);
+        else
+            fmpz_zero(c);
+        const uint64_t v = (uint64_t)fmpz_get_si(c);
+        for(int j=0; j<8; j++)
+            buf[j] = (unsigned char)(v >> (8*j));
+        if (EVP_DigestUpdate(ctx, buf, sizeof(buf)) != 1)
+            ggh_die("SHA-256 update failed.");
+    }
+    if (EVP_DigestFinal_ex(ctx, key, NULL) != 1)
+        ggh_die("SHA-256 finalisation failed.");
+    EVP_MD_CTX_free(ctx);
+
+    fmpz_clear(q2);
+    fmpz_clear(c);
+    if (!tmp)
+        gghlite_enc_clear(t_);
+}
+
+void
+gghlite_enc_rns_init(gghlite_enc_rns_t op, const gghlite_params_t self)
+{
+    assert(self->flags & GGHLITE_FLAGS_RNS);
+    assert(self->rns->k);
+    fmpz_mod_poly_oz_rns_init(op, self->n, self->rns);
+}
+
+void
+gghlite_enc_rns_set_gghlite_enc(gghlite_enc_rns_t rop, const gghlite_params_t self,
+                                const gghlite_enc_t op)
+{
+    fmpz_mod_poly_oz_rns_set_fmpz_mod_poly(rop, op, self->rns);
+}
+
+void
+gghlite_enc_set_gghlite_enc_rns(gghlite_enc_t rop, const gghlite_params_t self,
+                                const gghlite_enc_rns_t op)
+{
+    fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(rop, op, self->rns);
+}
+
+int
+gghlite_enc_rns_is_zero(const gghlite_params_t self, const gghlite_enc_rns_t op)
+{
+    gghlite_enc_t t;
+    int r;
+
+    gghlite_enc_init(t, self);
+    gghlite_enc_set_gghlite_enc_rns(t, self, op);
+    r = gghlite_enc_is_zero(self, t);
+    gghlite_enc_clear(t);
+    return r;
+}
+
+int
+gghlite_enc_arena_is_zero(const gghlite_params_t self, const gghlite_enc_arena_t op, const size_t i)
+{
+    gghlite_enc_t t;
+    int r;
+
+    gghlite_enc_init(t, self);
+    gghlite_enc_set_gghlite_enc_arena(t, op, i);
+    r = gghlite_enc_is_zero(self, t);
+    gghlite_enc_clear(t);
+    return r;
 }
@@ -0,0 +1,168 @@
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "gghlite-internals.h"
+#include "gghlite.h"
+#include "oz/util.h"
+
+static void *
+_gghlite_future_main(void *arg)
+{
+    struct _gghlite_future_struct *self = (struct _gghlite_future_struct *)arg;
+
+    /* loops in oz and gghlite poll this thread's flag */
+    oz_cancel_flag = &self->cancel;
+    const int cancelled = self->run(self);
+    oz_cancel_flag = NULL;
+
+    pthread_mutex_lock(&self->lock);
+    self->state = (cancelled) ? GGHLITE_FUTURE_CANCELLED : GGHLITE_FUTURE_DONE;
+    pthread_cond_broadcast(&self->cond);
+    pthread_mutex_unlock(&self->lock);
+    return NULL;
+}
+
+static void
+_gghlite_future_start(gghlite_future_t self, int (*run)(struct _gghlite_future_struct *))
+{
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->cond, NULL);
+    __atomic_store_n(&self->cancel, 0, __ATOMIC_RELAXED);
+    self->state = GGHLITE_FUTURE_PENDING;
+    self->result = 0;
+    self->joined = 0;
+    self->run = run;
+    if (pthread_create(&self->thread, NULL, _gghlite_future_main, self))
+        ggh_die("Cannot create thread.");
+}
+
+static int
+_gghlite_init_run(struct _gghlite_future_struct *self)
+{
+    gghlite_init(self->sk, self->lambda, self->kappa, self->gamma, self->rerand_mask, self->flags,
+                 self->randstate);
+    /* a half-generated instance is useless, release it here. The flag is read once, so the
+       state of the future always agrees with what happened to the secret key. */
+    if (oz_cancelled()) {
+        gghlite_sk_clear(self->sk, 1);
+        return 1;
+    }
+    return 0;
+}
+
+void
+gghlite_init_async(gghlite_future_t fut, gghlite_sk_t self, const size_t lambda, const size_t kappa,
+                   const size_t gamma, const uint64_t rerand_mask, const gghlite_flag_t flags,
+                   aes_randstate_t randstate)
+{
+    memset(fut, 0, sizeof(struct _gghlite_future_struct));
+    fut->sk = self;
+    fut->lambda = lambda;
+    fut->kappa = kappa;
+    fut->gamma = gamma;
+    fut->rerand_mask = rerand_mask;
+    fut->flags = flags;
+    fut->randstate = randstate;
+    _gghlite_future_start(fut, _gghlite_init_run);
+}
+
+static int
+_gghlite_enc_set_gghlite_clr_run(struct _gghlite_future_struct *self)
+{
+    gghlite_enc_set_gghlite_clr(self->rop, self->sk, self->f, self->k, self->group, self->rerand);
+    return oz_cancelled();
+}
+
+void
+gghlite_enc_set_gghlite_clr_async(gghlite_future_t fut, gghlite_enc_t rop, const gghlite_sk_t self,
+                                  const gghlite_clr_t f, const size_t k, int *group, const int rerand)
+{
+    memset(fut, 0, sizeof(struct _gghlite_future_struct));
+    fut->rop = rop;
+    fut->sk = (struct _gghlite_sk_struct *)self;
+    fut->f = f;
+    fut->k = k;
+    fut->group = group;
+    fut->rerand = rerand;
+    _gghlite_future_start(fut, _gghlite_enc_set_gghlite_clr_run);
+}
+
+static int
+_gghlite_enc_is_zero_run(struct _gghlite_future_struct *self)
+{
+    /* zero-testing does not poll the flag, its result is always valid */
+    self->result = gghlite_enc_is_zero(self->params, self->op);
+    return 0;
+}
+
+void
+gghlite_enc_is_zero_async(gghlite_future_t fut, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    memset(fut, 0, sizeof(struct _gghlite_future_struct));
+    fut->params = self;
+    fut->op = op;
+    _gghlite_future_start(fut, _gghlite_enc_is_zero_run);
+}
+
+gghlite_future_state_t
+gghlite_future_poll(gghlite_future_t self)
+{
+    pthread_mutex_lock(&self->lock);
+    const gghlite_future_state_t state = self->state;
+    pthread_mutex_unlock(&self->lock);
+    return state;
+}
+
+gghlite_future_state_t
+gghlite_future_wait(gghlite_future_t self, const uint64_t timeout)
+{
+    struct timespec deadline;
+    if (timeout) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        const uint64_t ns = deadline.tv_nsec + (timeout % 1000000) * 1000;
+        deadline.tv_sec += timeout / 1000000 + ns / 1000000000;
+        deadline.tv_nsec = ns % 1000000000;
+    }
+
+    pthread_mutex_lock(&self->lock);
+    while(self->state == GGHLITE_FUTURE_PENDING) {
+        if (!timeout) {
+            pthread_cond_wait(&self->cond, &self->lock);
+        } else if (pthread_cond_timedwait(&self->cond, &self->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    const gghlite_future_state_t state = self->state;
+    pthread_mutex_unlock(&self->lock);
+
+    if (state != GGHLITE_FUTURE_PENDING && !self->joined) {
+        pthread_join(self->thread, NULL);
+        self->joined = 1;
+    }
+    return state;
+}
+
+void
+gghlite_future_cancel(gghlite_future_t self)
+{
+    __atomic_store_n(&self->cancel, 1, __ATOMIC_RELEASE);
+}
+
+int
+gghlite_future_result(gghlite_future_t self)
+{
+    gghlite_future_wait(self, 0);
+    return self->result;
+}
+
+void
+gghlite_future_clear(gghlite_future_t self)
+{
+    if (!self->joined) {
+        gghlite_future_cancel(self);
+        gghlite_future_wait(self, 0);
+    }
+    pthread_cond_destroy(&self->cond);
+    pthread_mutex_destroy(&self->lock);
+}
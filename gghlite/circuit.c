@@ -0,0 +1,554 @@
+#include <assert.h>
+#include <string.h>
+#include <omp.h>
+
+#include "gghlite-internals.h"
+#include "gghlite.h"
+
+void
+gghlite_circuit_init(gghlite_circuit_t self, const gghlite_params_t params)
+{
+    memset(self, 0, sizeof(struct _gghlite_circuit_struct));
+    self->params = params;
+    self->width = gghlite_params_is_symmetric(params) ? 1 : params->gamma;
+    self->error = GGHLITE_CIRCUIT_NONE;
+}
+
+/**
+   Drop everything computed by `gghlite_circuit_compile`.
+*/
+
+static void
+_gghlite_circuit_uncompile(gghlite_circuit_t self)
+{
+    for(size_t i=0; i<self->len; i++) {
+        free(self->nodes[i].terms);
+        self->nodes[i].terms = NULL;
+        self->nodes[i].nterms = 0;
+        self->nodes[i].absorbed = 0;
+    }
+    free(self->schedule);
+    free(self->layer);
+    free(self->release);
+    free(self->release_layer);
+    self->schedule = NULL;
+    self->layer = NULL;
+    self->release = NULL;
+    self->release_layer = NULL;
+    self->nlayers = 0;
+    self->max_terms = 0;
+
+    if (self->compiled) {
+        gghlite_enc_clear(self->one);
+        gghlite_enc_clear(self->minus_one);
+    }
+    self->compiled = 0;
+}
+
+void
+gghlite_circuit_clear(gghlite_circuit_t self)
+{
+    _gghlite_circuit_uncompile(self);
+    free(self->nodes);
+    free(self->level);
+    memset(self, 0, sizeof(struct _gghlite_circuit_struct));
+}
+
+static size_t
+_gghlite_circuit_push(gghlite_circuit_t self, const gghlite_circuit_op_t op, const size_t a, const size_t b)
+{
+    if (a != GGHLITE_CIRCUIT_NONE && a >= self->len)
+        ggh_die("Operand %zu does not refer to an earlier node.", a);
+    if (b != GGHLITE_CIRCUIT_NONE && b >= self->len)
+        ggh_die("Operand %zu does not refer to an earlier node.", b);
+
+    if (self->compiled)
+        _gghlite_circuit_uncompile(self);
+
+    if (self->len == self->alloc) {
+        self->alloc = (self->alloc) ? 2*self->alloc : 64;
+        self->nodes = realloc(self->nodes, self->alloc * sizeof(gghlite_circuit_node_t));
+        self->level = realloc(self->level, self->alloc * self->width * sizeof(unsigned));
+    }
+
+    gghlite_circuit_node_t *node = self->nodes + self->len;
+    memset(node, 0, sizeof(gghlite_circuit_node_t));
+    node->op = op;
+    node->a = a;
+    node->b = b;
+    node->out = GGHLITE_CIRCUIT_NONE;
+    memset(self->level + self->len * self->width, 0, self->width * sizeof(unsigned));
+    return self->len++;
+}
+
+size_t
+gghlite_circuit_input(gghlite_circuit_t self, const size_t k, const int *group)
+{
+    const size_t i = _gghlite_circuit_push(self, GGHLITE_CIRCUIT_INPUT, GGHLITE_CIRCUIT_NONE, GGHLITE_CIRCUIT_NONE);
+    self->nodes[i].index = self->ninputs++;
+
+    unsigned *level = self->level + i * self->width;
+    if (self->width == 1) {
+        level[0] = k;
+    } else if (k) {
+        for(size_t r=0; r<self->width; r++)
+            level[r] = (group[r]) ? k : 0;
+    }
+    return i;
+}
+
+/**
+   Die unless `a` is an earlier node which produces an encoding.
+*/
+
+static void
+_gghlite_circuit_check_operand(const gghlite_circuit_t self, const size_t a)
+{
+    if (a == GGHLITE_CIRCUIT_NONE || a >= self->len)
+        ggh_die("Operand %zu does not refer to an earlier node.", a);
+    if (self->nodes[a].op == GGHLITE_CIRCUIT_IS_ZERO)
+        ggh_die("Zero-tests cannot be operands.");
+}
+
+size_t
+gghlite_circuit_add(gghlite_circuit_t self, const size_t a, const size_t b)
+{
+    _gghlite_circuit_check_operand(self, a);
+    _gghlite_circuit_check_operand(self, b);
+    return _gghlite_circuit_push(self, GGHLITE_CIRCUIT_ADD, a, b);
+}
+
+size_t
+gghlite_circuit_sub(gghlite_circuit_t self, const size_t a, const size_t b)
+{
+    _gghlite_circuit_check_operand(self, a);
+    _gghlite_circuit_check_operand(self, b);
+    return _gghlite_circuit_push(self, GGHLITE_CIRCUIT_SUB, a, b);
+}
+
+size_t
+gghlite_circuit_mul(gghlite_circuit_t self, const size_t a, const size_t b)
+{
+    _gghlite_circuit_check_operand(self, a);
+    _gghlite_circuit_check_operand(self, b);
+    return _gghlite_circuit_push(self, GGHLITE_CIRCUIT_MUL, a, b);
+}
+
+size_t
+gghlite_circuit_is_zero(gghlite_circuit_t self, const size_t a)
+{
+    _gghlite_circuit_check_operand(self, a);
+    const size_t i = _gghlite_circuit_push(self, GGHLITE_CIRCUIT_IS_ZERO, a, GGHLITE_CIRCUIT_NONE);
+    self->nodes[i].index = self->nzero++;
+    return i;
+}
+
+size_t
+gghlite_circuit_output(gghlite_circuit_t self, const size_t a)
+{
+    if (a >= self->len)
+        ggh_die("Node %zu does not exist.", a);
+    if (self->nodes[a].op == GGHLITE_CIRCUIT_IS_ZERO)
+        ggh_die("Zero-tests cannot be outputs.");
+
+    if (self->compiled)
+        _gghlite_circuit_uncompile(self);
+
+    if (self->nodes[a].out == GGHLITE_CIRCUIT_NONE)
+        self->nodes[a].out = self->noutputs++;
+    return self->nodes[a].out;
+}
+
+/**
+   Return 1 if `level` is valid, i.e. at most $κ$ in the symmetric setting and at most one $z_i$ per
+   group in the asymmetric setting.
+*/
+
+static int
+_gghlite_circuit_level_is_valid(const gghlite_circuit_t self, const unsigned *level)
+{
+    if (self->width == 1)
+        return level[0] <= self->params->kappa;
+    for(size_t r=0; r<self->width; r++)
+        if (level[r] > 1)
+            return 0;
+    return 1;
+}
+
+/**
+   Return 1 if `level` is the level at which zero-testing is possible.
+*/
+
+static int
+_gghlite_circuit_level_is_top(const gghlite_circuit_t self, const unsigned *level)
+{
+    if (self->width == 1)
+        return level[0] == self->params->kappa;
+    for(size_t r=0; r<self->width; r++)
+        if (level[r] != 1)
+            return 0;
+    return 1;
+}
+
+static int
+_gghlite_circuit_check_levels(gghlite_circuit_t self)
+{
+    const size_t w = self->width;
+
+    for(size_t i=0; i<self->len; i++) {
+        const gghlite_circuit_node_t *node = self->nodes + i;
+        unsigned *level = self->level + i*w;
+        const unsigned *la = (node->a != GGHLITE_CIRCUIT_NONE) ? self->level + node->a*w : NULL;
+        const unsigned *lb = (node->b != GGHLITE_CIRCUIT_NONE) ? self->level + node->b*w : NULL;
+
+        switch(node->op) {
+        case GGHLITE_CIRCUIT_INPUT:
+            break;
+        case GGHLITE_CIRCUIT_ADD:
+        case GGHLITE_CIRCUIT_SUB:
+            if (memcmp(la, lb, w * sizeof(unsigned)) != 0)
+                goto fail;
+            memcpy(level, la, w * sizeof(unsigned));
+            break;
+        case GGHLITE_CIRCUIT_MUL:
+            for(size_t r=0; r<w; r++)
+                level[r] = la[r] + lb[r];
+            break;
+        case GGHLITE_CIRCUIT_IS_ZERO:
+            if (!_gghlite_circuit_level_is_top(self, la))
+                goto fail;
+            break;
+        }
+
+        if (!_gghlite_circuit_level_is_valid(self, level))
+            goto fail;
+        continue;
+    fail:
+        self->error = i;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+   Return 1 if `node` may be folded into the node consuming it.
+*/
+
+static inline int
+_gghlite_circuit_is_foldable(const gghlite_circuit_node_t *node)
+{
+    return (node->op == GGHLITE_CIRCUIT_ADD || node->op == GGHLITE_CIRCUIT_SUB || node->op == GGHLITE_CIRCUIT_MUL)
+        && node->uses == 1 && node->out == GGHLITE_CIRCUIT_NONE;
+}
+
+/**
+   Rewrite the tree of single-use additions, subtractions and multiplications rooted at `root` as
+   $\\sum ± a_i·b_i$. Nothing is changed if the tree contains no multiplication.
+*/
+
+static void
+_gghlite_circuit_fuse(gghlite_circuit_t self, const size_t root)
+{
+    size_t alloc = 16, nterms = 0, nstack = 0, nfolded = 0, nproducts = 0;
+    gghlite_circuit_term_t *terms = malloc(alloc * sizeof(gghlite_circuit_term_t));
+    gghlite_circuit_term_t *stack = malloc((2*self->len + 2) * sizeof(gghlite_circuit_term_t));
+    size_t *folded = malloc(self->len * sizeof(size_t));
+
+    /* a stack, not recursion: chains of additions may be very long */
+    stack[nstack++] = (gghlite_circuit_term_t){root, GGHLITE_CIRCUIT_NONE, 1};
+
+    while(nstack) {
+        const gghlite_circuit_term_t t = stack[--nstack];
+        const gghlite_circuit_node_t *node = self->nodes + t.a;
+
+        if (nterms + 1 > alloc) {
+            alloc *= 2;
+            terms = realloc(terms, alloc * sizeof(gghlite_circuit_term_t));
+        }
+
+        if (t.a != root && !_gghlite_circuit_is_foldable(node)) {
+            terms[nterms++] = t;
+            continue;
+        }
+        if (t.a != root)
+            folded[nfolded++] = t.a;
+
+        switch(node->op) {
+        case GGHLITE_CIRCUIT_ADD:
+            stack[nstack++] = (gghlite_circuit_term_t){node->b, GGHLITE_CIRCUIT_NONE, t.sign};
+            stack[nstack++] = (gghlite_circuit_term_t){node->a, GGHLITE_CIRCUIT_NONE, t.sign};
+            break;
+        case GGHLITE_CIRCUIT_SUB:
+            stack[nstack++] = (gghlite_circuit_term_t){node->b, GGHLITE_CIRCUIT_NONE, -t.sign};
+            stack[nstack++] = (gghlite_circuit_term_t){node->a, GGHLITE_CIRCUIT_NONE, t.sign};
+            break;
+        case GGHLITE_CIRCUIT_MUL:
+            terms[nterms++] = (gghlite_circuit_term_t){node->a, node->b, t.sign};
+            nproducts++;
+            break;
+        default:
+            assert(0);
+        }
+    }
+
+    if (nproducts) {
+        for(size_t i=0; i<nfolded; i++)
+            self->nodes[folded[i]].absorbed = 1;
+        self->nodes[root].terms = realloc(terms, nterms * sizeof(gghlite_circuit_term_t));
+        self->nodes[root].nterms = nterms;
+        if (nterms > self->max_terms)
+            self->max_terms = nterms;
+    } else {
+        free(terms);
+    }
+    free(folded);
+    free(stack);
+}
+
+/**
+   Run `BODY` with `u` bound to every node read when evaluating `v`.
+*/
+
+#define _GGHLITE_CIRCUIT_FOREACH_OPERAND(self, v, u, BODY)              \
+    do {                                                                \
+        const gghlite_circuit_node_t *_node = (self)->nodes + (v);      \
+        if (_node->nterms) {                                            \
+            for(size_t _k=0; _k<_node->nterms; _k++) {                  \
+                size_t u = _node->terms[_k].a;                          \
+                BODY;                                                   \
+                if (_node->terms[_k].b != GGHLITE_CIRCUIT_NONE) {       \
+                    u = _node->terms[_k].b;                             \
+                    BODY;                                               \
+                }                                                       \
+            }                                                           \
+        } else {                                                        \
+            if (_node->a != GGHLITE_CIRCUIT_NONE) {                     \
+                size_t u = _node->a;                                    \
+                BODY;                                                   \
+            }                                                           \
+            if (_node->b != GGHLITE_CIRCUIT_NONE) {                     \
+                size_t u = _node->b;                                    \
+                BODY;                                                   \
+            }                                                           \
+        }                                                               \
+    } while(0)
+
+int
+gghlite_circuit_compile(gghlite_circuit_t self)
+{
+    if (self->compiled)
+        return 0;
+    _gghlite_circuit_uncompile(self);
+
+    self->error = GGHLITE_CIRCUIT_NONE;
+    if (_gghlite_circuit_check_levels(self) != 0)
+        return -1;
+
+    /* consumers */
+    for(size_t i=0; i<self->len; i++)
+        self->nodes[i].uses = (self->nodes[i].out != GGHLITE_CIRCUIT_NONE) ? 1 : 0;
+    for(size_t i=0; i<self->len; i++) {
+        const gghlite_circuit_node_t *node = self->nodes + i;
+        if (node->a != GGHLITE_CIRCUIT_NONE)
+            self->nodes[node->a].uses++;
+        if (node->b != GGHLITE_CIRCUIT_NONE)
+            self->nodes[node->b].uses++;
+    }
+
+    /* fuse multiply-add chains, from the back so that the largest trees are found first */
+    for(size_t i=self->len; i>0; i--) {
+        const gghlite_circuit_node_t *node = self->nodes + i - 1;
+        if (node->absorbed)
+            continue;
+        if (node->op == GGHLITE_CIRCUIT_ADD || node->op == GGHLITE_CIRCUIT_SUB)
+            _gghlite_circuit_fuse(self, i - 1);
+    }
+
+    /* layers: independent nodes share a layer */
+    self->nlayers = 1;
+    for(size_t v=0; v<self->len; v++) {
+        gghlite_circuit_node_t *node = self->nodes + v;
+        node->depth = 0;
+        node->last = 0;
+        if (node->absorbed || node->op == GGHLITE_CIRCUIT_INPUT)
+            continue;
+        _GGHLITE_CIRCUIT_FOREACH_OPERAND(self, v, u, {
+                if (self->nodes[u].depth + 1 > node->depth)
+                    node->depth = self->nodes[u].depth + 1;
+            });
+        if (node->depth + 1 > self->nlayers)
+            self->nlayers = node->depth + 1;
+    }
+
+    for(size_t v=0; v<self->len; v++) {
+        const gghlite_circuit_node_t *node = self->nodes + v;
+        if (node->absorbed || node->op == GGHLITE_CIRCUIT_INPUT)
+            continue;
+        /* results nobody reads are released right away */
+        if (node->depth > node->last)
+            self->nodes[v].last = node->depth;
+        _GGHLITE_CIRCUIT_FOREACH_OPERAND(self, v, u, {
+                if (node->depth > self->nodes[u].last)
+                    self->nodes[u].last = node->depth;
+            });
+    }
+
+    /* counting sort by layer for evaluation and by last use for releasing scratch */
+    self->layer = calloc(self->nlayers + 1, sizeof(size_t));
+    self->release_layer = calloc(self->nlayers + 1, sizeof(size_t));
+    size_t nschedule = 0, nrelease = 0;
+
+    for(size_t v=0; v<self->len; v++) {
+        const gghlite_circuit_node_t *node = self->nodes + v;
+        if (node->absorbed || node->op == GGHLITE_CIRCUIT_INPUT)
+            continue;
+        self->layer[node->depth + 1]++;
+        nschedule++;
+        if (node->op != GGHLITE_CIRCUIT_IS_ZERO && node->out == GGHLITE_CIRCUIT_NONE) {
+            self->release_layer[node->last + 1]++;
+            nrelease++;
+        }
+    }
+    for(size_t d=0; d<self->nlayers; d++) {
+        self->layer[d+1] += self->layer[d];
+        self->release_layer[d+1] += self->release_layer[d];
+    }
+
+    self->schedule = malloc((nschedule + 1) * sizeof(size_t));
+    self->release = malloc((nrelease + 1) * sizeof(size_t));
+    size_t *pos = calloc(2*self->nlayers, sizeof(size_t));
+
+    for(size_t v=0; v<self->len; v++) {
+        const gghlite_circuit_node_t *node = self->nodes + v;
+        if (node->absorbed || node->op == GGHLITE_CIRCUIT_INPUT)
+            continue;
+        self->schedule[self->layer[node->depth] + pos[node->depth]++] = v;
+        if (node->op != GGHLITE_CIRCUIT_IS_ZERO && node->out == GGHLITE_CIRCUIT_NONE)
+            self->release[self->release_layer[node->last] + pos[self->nlayers + node->last]++] = v;
+    }
+    free(pos);
+
+    gghlite_enc_init(self->one, self->params);
+    fmpz_mod_poly_oz_ntt_set_ui(self->one, 1, self->params->n);
+    gghlite_enc_init(self->minus_one, self->params);
+    fmpz_mod_poly_neg(self->minus_one, self->one);
+
+    self->compiled = 1;
+    return 0;
+}
+
+/**
+   Evaluate node `v`, `t` is scratch space and `f`, `g` hold at least `max_terms` entries.
+*/
+
+static void
+_gghlite_circuit_eval_node(gghlite_circuit_t self, fmpz_mod_poly_struct *val, int *is_zero, const size_t v,
+                           gghlite_enc_t t, fmpz_mod_poly_struct *f, fmpz_mod_poly_struct *g)
+{
+    const gghlite_circuit_node_t *node = self->nodes + v;
+    const struct _gghlite_params_struct *params = self->params;
+
+    if (node->op == GGHLITE_CIRCUIT_IS_ZERO) {
+        is_zero[node->index] = gghlite_enc_is_zero(params, val + node->a);
+        return;
+    }
+
+    gghlite_enc_init(val + v, params);
+
+    if (node->nterms) {
+        /* positive terms from the front, negative products from the back */
+        size_t np = 0, nn = 0;
+        for(size_t k=0; k<node->nterms; k++) {
+            const gghlite_circuit_term_t *term = node->terms + k;
+            if (term->b == GGHLITE_CIRCUIT_NONE) {
+                f[np] = val[term->a];
+                g[np] = (term->sign > 0) ? self->one[0] : self->minus_one[0];
+                np++;
+            } else if (term->sign > 0) {
+                f[np] = val[term->a];
+                g[np] = val[term->b];
+                np++;
+            } else {
+                nn++;
+                f[node->nterms - nn] = val[term->a];
+                g[node->nterms - nn] = val[term->b];
+            }
+        }
+        _fmpz_mod_poly_oz_ntt_inner_product(val + v, (fmpz_mod_poly_t*)f, (fmpz_mod_poly_t*)g, np, params->ntt);
+        if (nn) {
+            _fmpz_mod_poly_oz_ntt_inner_product(t, (fmpz_mod_poly_t*)(f + node->nterms - nn),
+                                                (fmpz_mod_poly_t*)(g + node->nterms - nn), nn, params->ntt);
+            gghlite_enc_sub(val + v, params, val + v, t);
+        }
+        return;
+    }
+
+    switch(node->op) {
+    case GGHLITE_CIRCUIT_ADD:
+        gghlite_enc_add(val + v, params, val + node->a, val + node->b);
+        break;
+    case GGHLITE_CIRCUIT_SUB:
+        gghlite_enc_sub(val + v, params, val + node->a, val + node->b);
+        break;
+    case GGHLITE_CIRCUIT_MUL:
+        gghlite_enc_mul(val + v, params, val + node->a, val + node->b);
+        break;
+    default:
+        assert(0);
+    }
+}
+
+int
+gghlite_circuit_eval(gghlite_enc_t *out, int *is_zero, gghlite_circuit_t self, gghlite_enc_t *in)
+{
+    if (gghlite_circuit_compile(self) != 0)
+        return -1;
+
+    fmpz_mod_poly_struct *val = calloc(self->len, sizeof(fmpz_mod_poly_struct));
+
+    /* inputs are not copied */
+    for(size_t v=0; v<self->len; v++)
+        if (self->nodes[v].op == GGHLITE_CIRCUIT_INPUT)
+            val[v] = in[self->nodes[v].index][0];
+
+    for(size_t d=1; d<self->nlayers; d++) {
+        const size_t start = self->layer[d];
+        const size_t end = self->layer[d+1];
+
+        /* a layer with a single node keeps all threads for that node */
+#pragma omp parallel if (end - start > 1)
+        {
+            gghlite_enc_t t;
+            gghlite_enc_init(t, self->params);
+            fmpz_mod_poly_struct *f = malloc((self->max_terms + 1) * sizeof(fmpz_mod_poly_struct));
+            fmpz_mod_poly_struct *g = malloc((self->max_terms + 1) * sizeof(fmpz_mod_poly_struct));
+
+#pragma omp for schedule(dynamic)
+            for(size_t j=start; j<end; j++)
+                _gghlite_circuit_eval_node(self, val, is_zero, self->schedule[j], t, f, g);
+
+            free(f);
+            free(g);
+            gghlite_enc_clear(t);
+        }
+
+        /* release intermediate values nobody reads any more */
+        for(size_t j=self->release_layer[d]; j<self->release_layer[d+1]; j++)
+            gghlite_enc_clear(val + self->release[j]);
+    }
+
+    for(size_t v=0; v<self->len; v++) {
+        const gghlite_circuit_node_t *node = self->nodes + v;
+        if (node->out == GGHLITE_CIRCUIT_NONE)
+            continue;
+        if (node->op == GGHLITE_CIRCUIT_INPUT) {
+            fmpz_mod_poly_set(out[node->out], in[node->index]);
+        } else {
+            fmpz_mod_poly_swap(out[node->out], val + v);
+            gghlite_enc_clear(val + v);
+        }
+    }
+
+    free(val);
+    return 0;
+}
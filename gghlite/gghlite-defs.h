@@ -7,6 +7,7 @@
 #define _DEFS_H_
 
 #include <gghlite/config.h>
+#include <pthread.h>
 #include <flint/fmpz_poly.h>
 #include <flint/fmpz_mod_poly.h>
 #include <dgsl/dgsl.h>
@@ -27,6 +28,48 @@ typedef fmpz_poly_t     gghlite_clr_t;
 
 typedef fmpz_mod_poly_t gghlite_enc_t;
 
+/**
+   Encodings in RNS representation, i.e. the slots of a `gghlite_enc_t` reduced modulo each
+   word-sized prime $p_i$ with $q = \\prod p_i$, see `GGHLITE_FLAGS_RNS`.
+**/
+
+typedef fmpz_mod_poly_oz_rns_t gghlite_enc_rns_t;
+
+/**
+   Arrays of encodings with all slots stored in one contiguous limb array, see `oz/arena.h`.
+   Encodings in an arena are addressed by their index.
+**/
+
+typedef fmpz_mod_poly_oz_arena_t gghlite_enc_arena_t;
+
+/**
+   Encodings with unreduced slots, used to accumulate long sums. Every slot $e_i$ satisfies
+   $|e_i| < \\mbox{bound}·q$, slots are only reduced modulo $q$ when `bound` would exceed
+   `GGHLITE_ENC_ACC_MAX_BOUND` or when converting back to `gghlite_enc_t`.
+**/
+
+typedef struct {
+    fmpz *slots;         //!< $n$ unreduced slots
+    size_t n;            //!< number of slots
+    size_t bound;        //!< all slots are smaller than bound·q in absolute value
+} gghlite_enc_acc_struct;
+
+typedef gghlite_enc_acc_struct gghlite_enc_acc_t[1];
+
+/**
+   Maximum bound (in multiples of $q$) an accumulator reaches before it is reduced.
+**/
+
+#ifndef GGHLITE_ENC_ACC_MAX_BOUND
+#define GGHLITE_ENC_ACC_MAX_BOUND (1UL<<16)
+#endif
+
+
+/**
+   Size of keys produced by `gghlite_enc_extract_key` in bytes.
+**/
+
+#define GGHLITE_KEY_BYTES 32
 
 /**
    @brief Flags controlling GGHLite behaviour
@@ -41,6 +84,8 @@ typedef enum {
     GGHLITE_FLAGS_QUIET      = 0x10, //!< suppress printing
     GGHLITE_FLAGS_GOOD_G_INV = 0x20, /*!< produce an inverse of $g$ with high-precision,
                                        set this if you plan to call gghlite_enc_set_gghlite_clr */
+    GGHLITE_FLAGS_RNS        = 0x40, /*!< pick $q$ as a product of word-sized primes $p_i ≡ 1 \\bmod 2n$,
+                                       enables computing with encodings in RNS representation */
 } gghlite_flag_t;
 
 /**
@@ -71,13 +116,15 @@ struct _gghlite_params_struct {
     mpfr_t ell_b;      //!< bound $ℓ_b$ on $σ_n(rot(B^(k)))$
     mpfr_t ell_g;      //!< bound $ℓ_g$ on $|g^-1|$
     mpfr_t xi;         //!< fraction $ξ$ of $q$ used for zero-testing
+    fmpz_t zero_bound; //!< zero-testing bound $\\lfloor q^{2(1-ξ)} \\rfloor$ on the squared norm
     gghlite_enc_t pzt; //!< zero-testing parameter $p_{zt}$
-    /* gghlite_enc_t ***x; /\*!< @brief level-$k$ encodings of zero $x_{i,k,j}$ for each source */
-    /*                         group $G_i$, level $k$ specified by rerand mask *\/ */
+    gghlite_enc_t ***x; //!< pools of level-$k$ encodings of zero $x_{i,k,j}$ for each source group $G_i$, level $k$ specified by rerand mask
+    size_t x_len;       //!< number of encodings of zero $x_{i,k,j}$ per pool
+    dgsl_rot_mp_t **D_sigma_s; //!< discrete Gaussian distributions $D_{\\ZZ^n,σ^*_k}$ for each level $k$ specified by rerand mask
     /* gghlite_enc_t *y; //!< one level-1 encodings of 1 (for each source group $G_i$) */
     /* dgsl_rot_mp_t *D_sigma_p; //!< discrete Gaussian distribution $D_{\\ZZ,σ'}$ */
-    /* dgsl_rot_mp_t *D_sigma_s; //!< discrete Gaussian distribution $D_{\\ZZ,σ^*}$ */
-    fmpz_mod_poly_oz_ntt_precomp_t ntt; //!< pre-computation data for computing in the NTT domain
+    fmpz_mod_poly_oz_ntt_precomp_struct *ntt; //!< shared pre-computation data for computing in the NTT domain
+    fmpz_oz_rns_t rns; //!< RNS basis with $q = \\prod p_i$, only used with `GGHLITE_FLAGS_RNS`
 };
 
 /**
@@ -88,6 +135,55 @@ struct _gghlite_params_struct {
 
 typedef struct _gghlite_params_struct gghlite_params_t[1];
 
+/**
+   Number of encodings of zero generated for each level in `rerand_mask`.
+*/
+
+#ifndef GGHLITE_RERAND_POOL_SIZE
+#define GGHLITE_RERAND_POOL_SIZE 16
+#endif
+
+/**
+   Number of encodings of zero combined by `gghlite_enc_rerand`.
+*/
+
+#ifndef GGHLITE_RERAND_SUBSET_SIZE
+#define GGHLITE_RERAND_SUBSET_SIZE 4
+#endif
+
+/**
+   Memory budget in bytes for products of $z_i^{-1}$ cached per secret key.
+
+   The number of entries is this budget divided by the size of one encoding, i.e. $n ⌈\log q⌉$ bits,
+   but at least one.
+*/
+
+#ifndef GGHLITE_Z_INV_CACHE_BYTES
+#define GGHLITE_Z_INV_CACHE_BYTES (((size_t)1)<<26)
+#endif
+
+/**
+   @brief Cached product @f$\prod_{i ∈ S} z_i^{-k}@f$ for a set $S$ of group indices.
+*/
+
+struct _gghlite_z_inv_cache_entry {
+    size_t k;            //!< exponent $k$
+    uint64_t hash;       //!< hash of $(k, S)$
+    uint64_t *group;     //!< bitmap of $S$
+    gghlite_enc_t z_inv; //!< product in the NTT domain
+};
+
+/**
+   @brief Bounded cache of products of $z_i^{-1}$, entries are never evicted.
+*/
+
+struct _gghlite_z_inv_cache_struct {
+    size_t len;          //!< number of entries in use
+    size_t alloc;        //!< maximum number of entries
+    size_t words;        //!< length of group bitmaps in 64-bit words
+    struct _gghlite_z_inv_cache_entry *entries;
+};
+
 /**
    @brief GGHLite "secret key".
 */
@@ -98,9 +194,11 @@ struct _gghlite_sk_struct {
     gghlite_clr_t g;     //!< a short principal ideal generator for $\\ideal{g}$
     fmpq_poly_t g_inv;   //!< approximate inverse of $g \\in \\Q[x]/(x^n+1)$
     dgsl_rot_mp_t *D_g;  //!< discrete Gaussian distribution $D_{\\ideal{g},σ'}$
+    fmpz_poly_oz_rem_small_ctx_t rem_ctx; //!< powers of $2^b \\bmod \\ideal{g}$ for reducing integers
 
     gghlite_enc_t *z;           //!< masking elements $z_i$
     gghlite_enc_t *z_inv;       //!< inverse of masking element $z_i$
+    struct _gghlite_z_inv_cache_struct *z_inv_cache; //!< products of $z_i^{-1}$ used for encoding
     gghlite_clr_t h;            //!< masking element $h$
 
     /* gghlite_clr_t *a; //!< an element $a \\bmod \\ideal{g} = 1$ (for each $G_i$) */
@@ -122,4 +220,131 @@ struct _gghlite_sk_struct {
 
 typedef struct _gghlite_sk_struct gghlite_sk_t[1];
 
+/**
+   @brief Operations in a circuit over encodings.
+*/
+
+typedef enum {
+    GGHLITE_CIRCUIT_INPUT = 0, //!< input encoding
+    GGHLITE_CIRCUIT_ADD,       //!< $a + b$
+    GGHLITE_CIRCUIT_SUB,       //!< $a - b$
+    GGHLITE_CIRCUIT_MUL,       //!< $a · b$
+    GGHLITE_CIRCUIT_IS_ZERO,   //!< zero-test $a$ at level $κ$
+} gghlite_circuit_op_t;
+
+/**
+   @brief Term $± a·b$ (or $± a$ if $b$ is `GGHLITE_CIRCUIT_NONE`) of a fused node.
+*/
+
+typedef struct {
+    size_t a;
+    size_t b;
+    int sign;
+} gghlite_circuit_term_t;
+
+#define GGHLITE_CIRCUIT_NONE ((size_t)-1)
+
+/**
+   @brief Node in a circuit, operands always refer to earlier nodes.
+*/
+
+typedef struct {
+    gghlite_circuit_op_t op;
+    size_t a;                      //!< first operand
+    size_t b;                      //!< second operand
+    size_t index;                  //!< index of input or zero-test
+    size_t out;                    //!< index of output or `GGHLITE_CIRCUIT_NONE`
+
+    int absorbed;                  //!< node was fused into a later node
+    size_t uses;                   //!< number of consumers (including being an output)
+    size_t depth;                  //!< length of longest path from an input
+    size_t last;                   //!< last layer reading this node
+    size_t nterms;                 //!< number of terms if the node computes $\\sum ± a_i·b_i$
+    gghlite_circuit_term_t *terms; //!< terms if the node computes $\\sum ± a_i·b_i$
+} gghlite_circuit_node_t;
+
+/**
+   @brief Circuit of additions, subtractions, multiplications and zero-tests over encodings.
+*/
+
+struct _gghlite_circuit_struct {
+    const struct _gghlite_params_struct *params; //!< GGHLite `params`, not owned
+
+    size_t len;                    //!< number of nodes
+    size_t alloc;                  //!< allocated number of nodes
+    gghlite_circuit_node_t *nodes; //!< nodes in insertion order
+    size_t width;                  //!< entries per level, $1$ (symmetric) or $γ$ (asymmetric)
+    unsigned *level;               //!< level of node $i$ at `level[i*width]`
+
+    size_t ninputs;                //!< number of inputs
+    size_t noutputs;               //!< number of outputs
+    size_t nzero;                  //!< number of zero-tests
+
+    int compiled;                  //!< `gghlite_circuit_compile` succeeded
+    size_t error;                  //!< first inconsistent node if compilation failed
+    size_t nlayers;                //!< number of layers, layer $0$ holds the inputs
+    size_t *schedule;              //!< nodes to evaluate ordered by layer
+    size_t *layer;                 //!< layer $i$ is `schedule[layer[i]:layer[i+1]]`
+    size_t *release;               //!< intermediate nodes ordered by the last layer reading them
+    size_t *release_layer;         //!< nodes released after layer $i$ are `release[release_layer[i]:release_layer[i+1]]`
+    size_t max_terms;              //!< maximum number of terms of a fused node
+    gghlite_enc_t one;             //!< $1$ in every slot, multiplier for linear terms
+    gghlite_enc_t minus_one;       //!< $-1$ in every slot, multiplier for linear terms
+};
+
+/**
+   @brief Circuit over encodings
+
+   @see _gghlite_circuit_struct
+*/
+
+typedef struct _gghlite_circuit_struct gghlite_circuit_t[1];
+
+/**
+   @brief State of an asynchronous operation.
+*/
+
+typedef enum {
+    GGHLITE_FUTURE_PENDING = 0,  //!< still running
+    GGHLITE_FUTURE_DONE = 1,     //!< finished, result is available
+    GGHLITE_FUTURE_CANCELLED = 2 //!< cancelled before it finished, outputs must be discarded
+} gghlite_future_state_t;
+
+/**
+   @brief Handle for an operation running on its own thread.
+*/
+
+struct _gghlite_future_struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int cancel;                  //!< set atomically by `gghlite_future_cancel`, polled by long running loops
+    gghlite_future_state_t state;
+    int result;                  //!< return value of the operation, if any
+    int joined;                  //!< thread was joined
+
+    int (*run)(struct _gghlite_future_struct *self); //!< returns 1 if it stopped because of a cancellation
+
+    /* arguments */
+    struct _gghlite_sk_struct *sk;
+    const struct _gghlite_params_struct *params;
+    fmpz_mod_poly_struct *rop;
+    const fmpz_mod_poly_struct *op;
+    const fmpz_poly_struct *f;
+    size_t lambda, kappa, gamma, k;
+    uint64_t rerand_mask;
+    gghlite_flag_t flags;
+    int *group;
+    int rerand;
+    void *randstate;
+};
+
+/**
+   @brief Handle for an operation running on its own thread
+
+   @see _gghlite_future_struct
+*/
+
+typedef struct _gghlite_future_struct gghlite_future_t[1];
+
 #endif /* _DEFS_H_ */
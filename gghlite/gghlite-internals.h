@@ -187,6 +187,27 @@ _gghlite_params_get_q_mpfr(mpfr_t q, const gghlite_params_t self, mpfr_rnd_t rnd
     mpz_clear(qz);
 }
 
+/**
+   @brief Set $\\lfloor q^{2(1-ξ)} \\rfloor$ used by `gghlite_enc_is_zero`, requires $q$ and $ξ$.
+*/
+
+void _gghlite_params_set_zero_bound(gghlite_params_t self);
+
+/**
+   @brief Set $σ^*_k = σ^*·(\sqrt{n}·σ')^{k-1}$, the width of the multipliers re-randomising level-$k$ encodings.
+*/
+
+void _gghlite_params_get_sigma_s(mpfr_t rop, const gghlite_params_t self, const size_t k);
+
+/**
+   @brief Allocate pools of `len` encodings of zero for each source group and each level in rerand_mask.
+
+   Also sets up the samplers $D_{\ZZ^n,σ^*_k}$ used by `gghlite_enc_rerand` for these levels, so
+   $σ^*$ and $σ'$ must be set.
+*/
+
+void _gghlite_params_init_x(gghlite_params_t self, const size_t len);
+
 /**
    @brief Sample $z_i$ and $z_i^{-1}$.
 */
@@ -202,10 +223,10 @@ void _gghlite_sk_sample_a(gghlite_sk_t self, aes_randstate_t randstate);
 void _gghlite_sk_set_pzt(gghlite_sk_t self);
 
 /**
-   @brief Set $c = (c⋅g)/z$ for some small $c$.
+   @brief Set $x_{i,k,j} = b_{k,j}/z_i^k$ for $b_{k,j} \sim D_{\ideal{g},σ'}$ for each level $k$ in rerand_mask.
 */
 
-void _gghlite_sk_set_x(gghlite_sk_t self);
+void _gghlite_sk_set_x(gghlite_sk_t self, aes_randstate_t randstate);
 
 /**
    @brief Set $y = (1 + c⋅g)/z$ for some small $c$ for each source group in rerand_mask.
@@ -303,6 +324,79 @@ static inline int gghlite_sk_is_symmetric(const gghlite_sk_t self) {
 double gghlite_log2_eucl_norm(const gghlite_sk_t self, const gghlite_enc_t op,
                               const size_t level, const size_t group);
 
+/**
+   @brief Write `x` in the byte order of the host, return 0 on success, -1 on failure.
+
+   @ingroup io
+*/
+
+int _gghlite_io_write_u64(FILE *fp, const uint64_t x);
+
+/**
+   @brief Read `x` written by `_gghlite_io_write_u64`, return 0 on success, -1 on failure.
+
+   @ingroup io
+*/
+
+int _gghlite_io_read_u64(uint64_t *x, FILE *fp);
+
+/**
+   @brief Write `x` as signed limb count followed by its limbs, return 0 on success, -1 on failure.
+
+   @ingroup io
+*/
+
+int _gghlite_io_write_fmpz(FILE *fp, const fmpz_t x);
+
+/**
+   @brief Read `x` written by `_gghlite_io_write_fmpz`, return 0 on success, -1 on failure.
+
+   @param avail     number of bytes left in the input, decreased by the number of bytes read. Inputs
+                    claiming more limbs than are left are rejected before allocating.
+
+   @ingroup io
+*/
+
+int _gghlite_io_read_fmpz(fmpz_t x, FILE *fp, size_t *avail);
+
+/**
+   @brief Write the first `len` entries of `vec` padded with zeros to length `n`, preceded by `n`.
+
+   @ingroup io
+*/
+
+int _gghlite_io_write_fmpz_vec(FILE *fp, const fmpz *vec, const size_t len, const size_t n);
+
+/**
+   @brief Read a vector written by `_gghlite_io_write_fmpz_vec` of length at most `n` into `rop`.
+
+   Coefficients outside of $[0,q)$ are rejected, see `_gghlite_io_read_fmpz` for `avail`.
+
+   @ingroup io
+*/
+
+int _gghlite_io_read_fmpz_mod_poly(fmpz_mod_poly_t rop, const size_t n, FILE *fp, size_t *avail);
+
+/**
+   @brief Read a vector written by `_gghlite_io_write_fmpz_vec` of length at most `n` into `rop`.
+
+   @see _gghlite_io_read_fmpz for `avail`
+
+   @ingroup io
+*/
+
+int _gghlite_io_read_fmpz_poly(fmpz_poly_t rop, const size_t n, FILE *fp, size_t *avail);
+
+/**
+   @brief Chunk size in bits used when reducing cleartexts modulo $\\ideal{g}$.
+*/
+
+static inline mp_bitcnt_t
+_gghlite_rem_small_prec(const gghlite_params_t self)
+{
+    return (self->n/4 < 8192) ? 8192 : self->n/4;
+}
+
 /**
    @brief Multiply $f$ by zero-testing parameter $p_{zt}$.
 
@@ -315,4 +409,21 @@ double gghlite_log2_eucl_norm(const gghlite_sk_t self, const gghlite_enc_t op,
 
 void _gghlite_enc_extract_raw(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t f);
 
+/**
+   @brief Multiply $f$ by @f$\prod_{i ∈ S} z_i^{-k}@f$ where $S$ are the indices set in `group`.
+
+   In the symmetric setting only the first index set in `group` is used. Products are computed
+   once and kept in a bounded cache on `self`, so each call costs one multiplication in the NTT
+   domain once the cache is warm. This function is thread-safe.
+
+   @param rop       valid encoding, multiplied in place
+   @param self      initialised secret key
+   @param k         exponent $k$
+   @param group     array of length $γ$
+
+   @ingroup internal-encodings
+*/
+
+void _gghlite_sk_mul_z_inv(gghlite_enc_t rop, const gghlite_sk_t self, const size_t k, const int *group);
+
 #endif /* _GGHLITE_INTERNALS_H_ */
@@ -3,6 +3,7 @@
 #include "gghlite.h"
 #include "oz/oz.h"
 #include "oz/flint-addons.h"
+#include "oz/util.h"
 
 void
 gghlite_sk_set_D_g(gghlite_sk_t self)
@@ -62,7 +63,7 @@ _gghlite_sk_sample_g(gghlite_sk_t self, aes_randstate_t randstate)
     fmpz_t N;
     fmpz_init(N);
 
-    while(1) {
+    while(!oz_cancelled()) {
         ggh_fprintf(stderr, self->params, "\r      Computing g:: !n: %4ld, !p: %4ld, !i: %4ld, !N: %4ld",
                     fail[0], fail[1], fail[2], fail[3]);
 
@@ -113,7 +114,7 @@ _gghlite_sk_sample_g(gghlite_sk_t self, aes_randstate_t randstate)
     }
     //4096 seems like a good choice
     const long prec = (self->params->n/4 < 8192) ? 8192 : self->params->n/4;
-    if (self->params->flags & GGHLITE_FLAGS_GOOD_G_INV) {
+    if ((self->params->flags & GGHLITE_FLAGS_GOOD_G_INV) && !oz_cancelled()) {
         /** we compute the inverse in high precision for gghlite_enc_set_gghlite_clr **/
         _fmpq_poly_oz_invert_approx(self->g_inv, g_q, self->params->n, prec);
     }
@@ -152,7 +153,7 @@ _gghlite_sk_set_pzt(gghlite_sk_t self)
         uint64_t t = ggh_walltime(0);
         for(size_t i=0; i<self->params->gamma; i++) {
             assert(!fmpz_mod_poly_is_zero(self->z[i]));
-            fmpz_mod_poly_oz_ntt_mul(z_kappa, z_kappa, self->z[i], self->params->n);
+            _fmpz_mod_poly_oz_ntt_mul(z_kappa, z_kappa, self->z[i], self->params->ntt);
             timer_printf("\r    Progress: [%lu / %lu] %8.2fs", i+1,
                          self->params->gamma, ggh_seconds(ggh_walltime(t)));
             fflush(stdout);
@@ -165,12 +166,12 @@ _gghlite_sk_set_pzt(gghlite_sk_t self)
     fmpz_mod_poly_oz_ntt_inv(g_inv, g_inv, self->params->n);
 
     fmpz_mod_poly_t pzt;  fmpz_mod_poly_init(pzt, self->params->q);
-    fmpz_mod_poly_oz_ntt_mul(pzt, z_kappa, g_inv, self->params->n);
+    _fmpz_mod_poly_oz_ntt_mul(pzt, z_kappa, g_inv, self->params->ntt);
 
     fmpz_mod_poly_t h;  fmpz_mod_poly_init(h, self->params->q);
     fmpz_mod_poly_oz_ntt_enc_fmpz_poly(h, self->h, self->params->ntt);
 
-    fmpz_mod_poly_oz_ntt_mul(pzt, pzt, h, self->params->n);
+    _fmpz_mod_poly_oz_ntt_mul(pzt, pzt, h, self->params->ntt);
 
     fmpz_mod_poly_init(self->params->pzt, self->params->q);
     fmpz_mod_poly_set(self->params->pzt, pzt);
@@ -243,7 +244,6 @@ _gghlite_sk_sample_z(gghlite_sk_t self, aes_randstate_t randstate)
     for(size_t i = 0; i < bound; i++) {
         fmpz_mod_poly_oz_ntt_enc(self->z[i], self->z[i], self->params->ntt);
         fmpz_mod_poly_init(self->z_inv[i], self->params->q);
-        fmpz_mod_poly_oz_ntt_inv(self->z_inv[i], self->z[i], self->params->n);
 #pragma omp critical
         {
             progress_count_approx++;
@@ -252,6 +252,136 @@ _gghlite_sk_sample_z(gghlite_sk_t self, aes_randstate_t randstate)
         }
     }
     timer_printf("\n");
+
+    /* one batch inversion for all z_i */
+    fmpz_mod_poly_oz_ntt_inv_batch(self->z_inv, self->z, bound, self->params->n);
+}
+
+void
+_gghlite_sk_set_x(gghlite_sk_t self, aes_randstate_t randstate)
+{
+    assert(self->params);
+    assert(self->D_g);
+
+    if (!self->params->rerand_mask)
+        return;
+
+    _gghlite_params_init_x(self->params, GGHLITE_RERAND_POOL_SIZE);
+
+    const size_t bound = (gghlite_sk_is_symmetric(self)) ? 1 : self->params->gamma;
+    const size_t len = self->params->x_len;
+
+    int *group = calloc(self->params->gamma, sizeof(int));
+    fmpz_poly_t *b = calloc(len, sizeof(fmpz_poly_t));
+    for(size_t j=0; j<len; j++)
+        fmpz_poly_init(b[j]);
+
+    for(size_t i=0; i<bound && !oz_cancelled(); i++) {
+        memset(group, 0, self->params->gamma * sizeof(int));
+        group[i] = 1;
+
+        for(size_t k=0; k<self->params->kappa && !oz_cancelled(); k++) {
+            if (!gghlite_params_have_rerand(self->params, k))
+                continue;
+
+            /* do not parallelize calls to randomness generation! */
+            for(size_t j=0; j<len; j++)
+                fmpz_poly_sample_D(b[j], self->D_g, randstate);
+
+            gghlite_enc_t *x = self->params->x[i][k];
+#pragma omp parallel for
+            for(size_t j=0; j<len; j++) {
+                fmpz_mod_poly_oz_ntt_enc_fmpz_poly(x[j], b[j], self->params->ntt);
+                _gghlite_sk_mul_z_inv(x[j], self, gghlite_sk_is_symmetric(self) ? k+1 : 1, group);
+            }
+            timer_printf("\r    Progress: [%lu / %lu] [%lu / %lu]", i+1, bound, k+1, self->params->kappa);
+        }
+    }
+    timer_printf("\n");
+
+    for(size_t j=0; j<len; j++)
+        fmpz_poly_clear(b[j]);
+    free(b);
+    free(group);
+}
+
+static struct _gghlite_z_inv_cache_entry *
+_gghlite_z_inv_cache_find(const struct _gghlite_z_inv_cache_struct *cache, const size_t k,
+                          const uint64_t hash, const uint64_t *group)
+{
+    for(size_t i=0; i<cache->len; i++) {
+        struct _gghlite_z_inv_cache_entry *e = cache->entries + i;
+        if (e->hash == hash && e->k == k && memcmp(e->group, group, cache->words * sizeof(uint64_t)) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+void
+_gghlite_sk_mul_z_inv(gghlite_enc_t rop, const gghlite_sk_t self, const size_t k, const int *group)
+{
+    struct _gghlite_z_inv_cache_struct *cache = self->z_inv_cache;
+    const int symmetric = gghlite_sk_is_symmetric(self);
+
+    /* canonical key: bitmap of group indices, only the first index counts in the symmetric case */
+    uint64_t bitmap[cache->words];
+    memset(bitmap, 0, cache->words * sizeof(uint64_t));
+    for(size_t r=0; r<self->params->gamma; r++) {
+        if (group[r]) {
+            bitmap[r/64] |= ((uint64_t)1)<<(r%64);
+            if (symmetric)
+                break;
+        }
+    }
+
+    /* FNV-1a */
+    uint64_t hash = 0xcbf29ce484222325ULL ^ k;
+    for(size_t i=0; i<cache->words; i++) {
+        hash ^= bitmap[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    struct _gghlite_z_inv_cache_entry *e;
+#pragma omp critical (gghlite_z_inv_cache)
+    e = _gghlite_z_inv_cache_find(cache, k, hash, bitmap);
+
+    if (!e) {
+        /* compute outside of the critical section, another thread might do the same */
+        gghlite_enc_t t;
+        gghlite_enc_init(t, self->params);
+        fmpz_mod_poly_oz_ntt_set_ui(t, 1, self->params->n);
+        for(size_t r=0; r<self->params->gamma; r++) {
+            if (bitmap[r/64] & (((uint64_t)1)<<(r%64))) {
+                for(size_t j=0; j<k; j++)
+                    _fmpz_mod_poly_oz_ntt_mul(t, t, self->z_inv[r], self->params->ntt);
+            }
+        }
+
+#pragma omp critical (gghlite_z_inv_cache)
+        {
+            e = _gghlite_z_inv_cache_find(cache, k, hash, bitmap);
+            if (!e && cache->len < cache->alloc) {
+                e = cache->entries + cache->len;
+                e->k = k;
+                e->hash = hash;
+                e->group = malloc(cache->words * sizeof(uint64_t));
+                memcpy(e->group, bitmap, cache->words * sizeof(uint64_t));
+                gghlite_enc_init(e->z_inv, self->params);
+                fmpz_mod_poly_swap(e->z_inv, t);
+                cache->len++;
+            }
+        }
+
+        if (!e) {
+            /* cache is full */
+            _fmpz_mod_poly_oz_ntt_mul(rop, rop, t, self->params->ntt);
+            gghlite_enc_clear(t);
+            return;
+        }
+        gghlite_enc_clear(t);
+    }
+
+    _fmpz_mod_poly_oz_ntt_mul(rop, rop, e->z_inv, self->params->ntt);
 }
 
 void
@@ -274,10 +404,27 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
 
     self->z     = calloc(self->params->gamma, sizeof(gghlite_enc_t));
     self->z_inv = calloc(self->params->gamma, sizeof(gghlite_enc_t));
+
+    self->z_inv_cache = calloc(1, sizeof(struct _gghlite_z_inv_cache_struct));
+    const size_t z_inv_bytes = self->params->n * fmpz_size(self->params->q) * sizeof(mp_limb_t);
+    self->z_inv_cache->alloc = GGHLITE_Z_INV_CACHE_BYTES / z_inv_bytes;
+    if (self->z_inv_cache->alloc == 0)
+        self->z_inv_cache->alloc = 1;
+    self->z_inv_cache->words = (self->params->gamma + 63)/64;
+    self->z_inv_cache->entries = calloc(self->z_inv_cache->alloc, sizeof(struct _gghlite_z_inv_cache_entry));
   
     start_timer();
     timer_printf("Starting precomp init...\n");
-    fmpz_mod_poly_oz_ntt_precomp_init(self->params->ntt, self->params->n, self->params->q);
+    if (self->params->flags & GGHLITE_FLAGS_RNS) {
+        /* q is composite, obtain φ from the φ_i mod p_i via the CRT */
+        fmpz_t phi;
+        fmpz_init(phi);
+        fmpz_oz_rns_root(phi, self->params->rns, self->params->n);
+        self->params->ntt = _fmpz_mod_poly_oz_ntt_precomp_ref(self->params->n, self->params->q, phi);
+        fmpz_clear(phi);
+    } else {
+        self->params->ntt = fmpz_mod_poly_oz_ntt_precomp_ref(self->params->n, self->params->q);
+    }
     timer_printf("Finished precomp init");
     print_timer();
     timer_printf("\n");
@@ -288,6 +435,18 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     timer_printf("Finished sampling g");
     print_timer();
     timer_printf("\n");
+    if (oz_cancelled())
+        return;
+
+    start_timer();
+    timer_printf("Starting reduction precomp...\n");
+    fmpz_poly_oz_rem_small_ctx_init(self->rem_ctx, self->g, self->params->n, self->g_inv,
+                                    _gghlite_rem_small_prec(self->params));
+    timer_printf("Finished reduction precomp");
+    print_timer();
+    timer_printf("\n");
+    if (oz_cancelled())
+        return;
   
     start_timer();
     timer_printf("Starting sampling z...\n");
@@ -295,6 +454,8 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     timer_printf("Finished sampling z");
     print_timer();
     timer_printf("\n");
+    if (oz_cancelled())
+        return;
   
     start_timer();
     timer_printf("Starting sampling h...\n");
@@ -302,6 +463,8 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     timer_printf("Finished sampling h");
     print_timer();
     timer_printf("\n");
+    if (oz_cancelled())
+        return;
 
     start_timer();
     timer_printf("Starting setting D_g...\n");
@@ -309,6 +472,8 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     timer_printf("Finished setting D_g");
     print_timer();
     timer_printf("\n");
+    if (oz_cancelled())
+        return;
 
     start_timer();
     timer_printf("Starting setting pzt...\n");
@@ -316,6 +481,15 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     timer_printf("Finished setting pzt");
     print_timer();
     timer_printf("\n");
+    if (oz_cancelled())
+        return;
+
+    start_timer();
+    timer_printf("Starting setting x...\n");
+    _gghlite_sk_set_x(self, randstate);
+    timer_printf("Finished setting x");
+    print_timer();
+    timer_printf("\n");
 }
 
 void
@@ -340,12 +514,24 @@ gghlite_sk_clear(gghlite_sk_t self, int clear_params)
 
     fmpz_poly_clear(self->h);
     fmpz_poly_clear(self->g);
+    fmpz_poly_oz_rem_small_ctx_clear(self->rem_ctx);
     fmpq_poly_clear(self->g_inv);
-    dgsl_rot_mp_clear(self->D_g);
+    if (self->D_g)
+        dgsl_rot_mp_clear(self->D_g);
 
     free(self->z);
     free(self->z_inv);
 
+    if (self->z_inv_cache) {
+        for(size_t i=0; i<self->z_inv_cache->len; i++) {
+            gghlite_enc_clear(self->z_inv_cache->entries[i].z_inv);
+            free(self->z_inv_cache->entries[i].group);
+        }
+        free(self->z_inv_cache->entries);
+        free(self->z_inv_cache);
+        self->z_inv_cache = NULL;
+    }
+
     if (clear_params)
         gghlite_params_clear(self->params);
 }
@@ -451,7 +637,7 @@ _gghlite_enc_extract_raw(gghlite_clr_t rop, const gghlite_params_t self,
 {
     gghlite_enc_t t;
     gghlite_enc_init(t, self);
-    fmpz_mod_poly_oz_ntt_mul(t, self->pzt, op, self->n);
+    _fmpz_mod_poly_oz_ntt_mul(t, self->pzt, op, self->ntt);
     fmpz_mod_poly_oz_ntt_dec(t, t, self->ntt);
     fmpz_poly_set_fmpz_mod_poly(rop, t);
     gghlite_enc_clear(t);
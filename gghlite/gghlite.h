@@ -437,6 +437,29 @@ gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
                             const gghlite_clr_t f, const size_t k, int *group,
                             const int rerand);
 
+/**
+   @brief Encode $f_i$ at level-$k_i$ in group `group[i]` for all $0 ≤ i <$ `len`.
+
+   Items are encoded in parallel. If `rerand` is set, one seed is drawn from `self->rng` and item
+   $i$ is re-randomised from its own AES stream keyed by the seed and $i$, hence the output does
+   not depend on the number of threads or on scheduling.
+
+   @param rop       array of `len` initialised encodings, return values
+   @param self      initialised GGHLite instance
+   @param f         array of `len` elements in $\ZZ[x]/(x^n+1)$
+   @param len       number of elements
+   @param k         array of `len` target levels
+   @param group     array of `len` arrays of length $γ$
+   @param rerand    flag controlling if re-randomisation is run after raising
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_set_gghlite_clr_batch(gghlite_enc_t *rop, const gghlite_sk_t self,
+                                  gghlite_clr_t *f, const size_t len, const size_t *k, int **group,
+                                  const int rerand);
+
 /**
    @brief Encode $f$ at level-$0$.
 
@@ -473,7 +496,104 @@ static inline void
 gghlite_enc_mul(gghlite_enc_t h, const gghlite_params_t self,
                 const gghlite_enc_t f, const gghlite_enc_t g)
 {
-    fmpz_mod_poly_oz_ntt_mul(h, f, g, self->n);
+    _fmpz_mod_poly_oz_ntt_mul(h, f, g, self->ntt);
+}
+
+/**
+   @brief Compute $h = h + f·g$.
+
+   @param h         initialised encoding, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding
+   @param g         valid encoding
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_addmul(gghlite_enc_t h, const gghlite_params_t self,
+                   const gghlite_enc_t f, const gghlite_enc_t g)
+{
+    _fmpz_mod_poly_oz_ntt_addmul(h, f, g, self->ntt);
+}
+
+/**
+   @brief Compute $\\mbox{rop} = \\sum_{0 ≤ k < \\mbox{len}} f_k·g_k$.
+
+   Each slot is reduced modulo $q$ once, instead of once per product and once per sum.
+
+   @param rop       initialised encoding, return value
+   @param self      initialised GGHLite `params`
+   @param f         array of `len` valid encodings
+   @param g         array of `len` valid encodings
+   @param len       number of products
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_inner_product(gghlite_enc_t rop, const gghlite_params_t self,
+                          gghlite_enc_t *f, gghlite_enc_t *g, const size_t len)
+{
+    _fmpz_mod_poly_oz_ntt_inner_product(rop, f, g, len, self->ntt);
+}
+
+/**
+   @brief Compute $\\mbox{rop} = \\mbox{op}(x^k)$.
+
+   Automorphisms only permute slots in the NTT domain, so this does not require any transform.
+
+   @param rop       initialised encoding, return value
+   @param self      initialised GGHLite `params`
+   @param op        valid encoding
+   @param k         exponent, must be odd
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_automorphism(gghlite_enc_t rop, const gghlite_params_t self,
+                         const gghlite_enc_t op, const long k)
+{
+    _fmpz_mod_poly_oz_ntt_automorphism(rop, op, k, self->ntt);
+}
+
+/**
+   @brief Re-randomise a level-$k$ encoding using the public encodings of zero.
+
+   Compute $\mbox{rop} = \mbox{op} + \sum_j ρ_j·x_{i,k,j}$ for a random subset of
+   `GGHLITE_RERAND_SUBSET_SIZE` elements of the pool of level-$k$ encodings of zero generated
+   by `gghlite_init` and $ρ_j \sim D_{\ZZ^n,σ^*_k}$, where $σ^*_k$ grows with $k$ to cover the
+   noise of level-$k$ encodings.
+
+   @param rop       initialised encoding, return value
+   @param self      initialised GGHLite `params` with re-randomisers for level $k$
+   @param op        valid encoding at level $k$ in group $G_i$
+   @param k         level $1 ≤ k ≤ κ$
+   @param i         group index (ignored in the symmetric setting)
+   @param randstate entropy source
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_rerand(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                        const size_t k, const size_t i, aes_randstate_t randstate);
+
+/**
+   @brief Compute $\\mbox{rop} = \\mbox{op}^T = \\mbox{op}(x^{-1})$.
+
+   @param rop       initialised encoding, return value
+   @param self      initialised GGHLite `params`
+   @param op        valid encoding
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_conjugate(gghlite_enc_t rop, const gghlite_params_t self,
+                      const gghlite_enc_t op)
+{
+    fmpz_mod_poly_oz_ntt_conjugate(rop, op, self->n);
 }
 
 /**
@@ -514,9 +634,105 @@ gghlite_enc_sub(gghlite_enc_t h, const gghlite_params_t self,
     fmpz_mod_poly_sub(h, f, g);
 }
 
+/**
+   @brief Initialise accumulator to zero.
+
+   @param op        uninitialised accumulator
+   @param self      initialised GGHLite `params`
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_init(gghlite_enc_acc_t op, const gghlite_params_t self);
+
+/**
+   @brief Clear accumulator.
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_clear(gghlite_enc_acc_t op);
+
+/**
+   @brief Reduce all slots of `op` to $[0,q)$.
+
+   @param op        initialised accumulator
+   @param self      initialised GGHLite `params`
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_reduce(gghlite_enc_acc_t op, const gghlite_params_t self);
+
+/**
+   @brief Set accumulator to $f$.
+
+   @param rop       initialised accumulator, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_set_gghlite_enc(gghlite_enc_acc_t rop, const gghlite_params_t self, const gghlite_enc_t f);
+
+/**
+   @brief Compute $h = h + f$ without reducing modulo $q$.
+
+   @param h         initialised accumulator, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_add(gghlite_enc_acc_t h, const gghlite_params_t self, const gghlite_enc_t f);
+
+/**
+   @brief Compute $h = h - f$ without reducing modulo $q$.
+
+   @param h         initialised accumulator, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_sub(gghlite_enc_acc_t h, const gghlite_params_t self, const gghlite_enc_t f);
+
+/**
+   @brief Compute $h = h + f$ for two accumulators.
+
+   @param h         initialised accumulator, return value
+   @param self      initialised GGHLite `params`
+   @param f         initialised accumulator
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_acc_add_acc(gghlite_enc_acc_t h, const gghlite_params_t self, const gghlite_enc_acc_t f);
+
+/**
+   @brief Set `rop` to the encoding held by `op`, reducing modulo $q$.
+
+   Call this before multiplying or zero-testing the sum.
+
+   @param rop       initialised encoding, return value
+   @param self      initialised GGHLite `params`
+   @param op        initialised accumulator
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_set_gghlite_enc_acc(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_acc_t op);
+
 /**
    @brief Return 1 if $f$ is an encoding of zero at level $κ$
 
+   Coefficients of $p_{zt}·f$ are scanned in centred representation against the squared bound
+   precomputed in `params`, stopping at the first coefficient which proves that $f$ is not an
+   encoding of zero.
+
    @param self      initialised GGHLite `params`
    @param f         valid encoding at level-$k$
 
@@ -526,6 +742,602 @@ gghlite_enc_sub(gghlite_enc_t h, const gghlite_params_t self,
 int
 gghlite_enc_is_zero(const gghlite_params_t self, const gghlite_enc_t op);
 
+/**
+   @brief Extract canonical string from $f$, i.e. the $ℓ$ most significant bits of each coefficient
+   of $[p_{zt}·f]_q$ in centred representation.
+
+   @param rop       initialised clear element, return value
+   @param self      initialised GGHLite `params`
+   @param op        valid encoding at level-$κ$
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_extract(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t op);
+
+/**
+   @brief Derive a `GGHLITE_KEY_BYTES` byte key from $f$.
+
+   The coefficients produced by `gghlite_enc_extract` are fed into SHA-256 one by one as they are
+   computed, without building the clear element first. All parties holding encodings of the same
+   element at level $κ$ derive the same key.
+
+   @param key       buffer of `GGHLITE_KEY_BYTES` bytes, return value
+   @param self      initialised GGHLite `params`
+   @param op        valid encoding at level-$κ$
+   @param tmp       initialised encoding used as scratch space, may be `NULL` in which case scratch
+                    space is allocated
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_extract_key(unsigned char *key, const gghlite_params_t self, const gghlite_enc_t op,
+                        gghlite_enc_t tmp);
+
+/**
+   @brief Zero-test `len` encodings in parallel.
+
+   Encodings are distributed dynamically across OpenMP threads, each of which allocates its
+   scratch space once. The transforms for each encoding run serially inside its thread.
+
+   @param rop       bitmap of $\\lceil \\mbox{len}/64 \\rceil$ words, bit `i%64` of word `i/64` is set
+                    iff `op[i]` is an encoding of zero
+   @param scanned   if not `NULL`, array of length `len` receiving the number of coefficients
+                    inspected for each encoding before a decision was reached
+   @param self      initialised GGHLite `params`
+   @param op        array of `len` valid encodings at level-$κ$
+   @param len       number of encodings
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_is_zero_batch(uint64_t *rop, size_t *scanned, const gghlite_params_t self,
+                          gghlite_enc_t *op, const size_t len);
+
+/**
+   @brief Initialise RNS encoding to zero.
+
+   @param op        uninitialised RNS encoding
+   @param self      initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_rns_init(gghlite_enc_rns_t op, const gghlite_params_t self);
+
+#define gghlite_enc_rns_clear fmpz_mod_poly_oz_rns_clear
+
+/**
+   @brief Set `rop` to the RNS representation of `op`.
+
+   @param rop       initialised RNS encoding
+   @param self      initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+   @param op        valid encoding
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_rns_set_gghlite_enc(gghlite_enc_rns_t rop, const gghlite_params_t self, const gghlite_enc_t op);
+
+/**
+   @brief Set `rop` to the encoding represented by `op` (via the CRT).
+
+   @param rop       initialised encoding
+   @param self      initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+   @param op        valid RNS encoding
+
+   @ingroup encodings
+*/
+
+void gghlite_enc_set_gghlite_enc_rns(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_rns_t op);
+
+/**
+   @brief Compute $h = f·g$ in RNS representation.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_rns_mul(gghlite_enc_rns_t h, const gghlite_params_t self,
+                    const gghlite_enc_rns_t f, const gghlite_enc_rns_t g)
+{
+    fmpz_mod_poly_oz_rns_mul(h, f, g, self->rns);
+}
+
+/**
+   @brief Compute $h = f+g$ in RNS representation.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_rns_add(gghlite_enc_rns_t h, const gghlite_params_t self,
+                    const gghlite_enc_rns_t f, const gghlite_enc_rns_t g)
+{
+    fmpz_mod_poly_oz_rns_add(h, f, g, self->rns);
+}
+
+/**
+   @brief Compute $h = f-g$ in RNS representation.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_rns_sub(gghlite_enc_rns_t h, const gghlite_params_t self,
+                    const gghlite_enc_rns_t f, const gghlite_enc_rns_t g)
+{
+    fmpz_mod_poly_oz_rns_sub(h, f, g, self->rns);
+}
+
+/**
+   @brief Return 1 if $f$ is an encoding of zero at level $κ$
+
+   The encoding is reconstructed modulo $q$ via the CRT before zero-testing.
+
+   @param self      initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+   @param op        valid RNS encoding at level-$κ$
+
+   @ingroup encodings
+*/
+
+int
+gghlite_enc_rns_is_zero(const gghlite_params_t self, const gghlite_enc_rns_t op);
+
+/**
+   @brief Initialise an arena of `len` encodings to zero.
+
+   @param op        uninitialised arena
+   @param self      initialised GGHLite `params`
+   @param len       number of encodings
+   @param flags     pass `OZ_HUGEPAGES` to request transparent huge pages
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_arena_init(gghlite_enc_arena_t op, const gghlite_params_t self, const size_t len, const oz_flag_t flags)
+{
+    fmpz_mod_poly_oz_arena_init(op, len, self->n, self->q, flags);
+}
+
+#define gghlite_enc_arena_clear fmpz_mod_poly_oz_arena_clear
+
+/**
+   @brief Set encoding $i$ of `rop` to `op`.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_arena_set_gghlite_enc(gghlite_enc_arena_t rop, const size_t i, const gghlite_enc_t op)
+{
+    fmpz_mod_poly_oz_arena_set_fmpz_mod_poly(rop, i, op);
+}
+
+/**
+   @brief Set `rop` to encoding $i$ of `op`.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_set_gghlite_enc_arena(gghlite_enc_t rop, const gghlite_enc_arena_t op, const size_t i)
+{
+    fmpz_mod_poly_oz_arena_get_fmpz_mod_poly(rop, op, i);
+}
+
+/**
+   @brief Set encoding $h$ to the product of encodings $f$ and $g$ of `op`.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_arena_mul(gghlite_enc_arena_t op, const size_t h, const size_t f, const size_t g)
+{
+    fmpz_mod_poly_oz_arena_mul(op, h, f, g);
+}
+
+/**
+   @brief Set encoding $h$ to the sum of encodings $f$ and $g$ of `op`.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_arena_add(gghlite_enc_arena_t op, const size_t h, const size_t f, const size_t g)
+{
+    fmpz_mod_poly_oz_arena_add(op, h, f, g);
+}
+
+/**
+   @brief Set encoding $h$ to the difference of encodings $f$ and $g$ of `op`.
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_arena_sub(gghlite_enc_arena_t op, const size_t h, const size_t f, const size_t g)
+{
+    fmpz_mod_poly_oz_arena_sub(op, h, f, g);
+}
+
+/**
+   @brief Return 1 if encoding $i$ of `op` is an encoding of zero at level $κ$.
+
+   @ingroup encodings
+*/
+
+int
+gghlite_enc_arena_is_zero(const gghlite_params_t self, const gghlite_enc_arena_t op, const size_t i);
+
+/**
+   @defgroup io Input & Output
+
+   Files start with a header holding a magic string, a format version, the writer's byte order
+   and limb size. Files written on an architecture with a different byte order or limb size are
+   rejected.
+*/
+
+/**
+   @brief Write `params` including $p_{zt}$, the re-randomisation pools and the root of unity
+   used for the NTT to `fp`.
+
+   @param fp        file opened for writing in binary mode
+   @param self      initialised GGHLite `params`
+   @return 0 on success, -1 on failure
+
+   @ingroup io
+*/
+
+int gghlite_params_fwrite(FILE *fp, const gghlite_params_t self);
+
+/**
+   @brief Read `params` written by `gghlite_params_fwrite` from `fp`.
+
+   NTT pre-computations are obtained from the shared registry without searching for a root of
+   unity. On success `self` must be cleared with `gghlite_params_clear`, on failure it is left
+   uninitialised.
+
+   @param self      uninitialised GGHLite `params`
+   @param fp        file opened for reading in binary mode
+   @return 0 on success, -1 on failure
+
+   @ingroup io
+*/
+
+int gghlite_params_fread(gghlite_params_t self, FILE *fp);
+
+/**
+   @brief Write an arena of encodings to `fp`.
+
+   Slots are written in the arena's own layout starting at a page-aligned offset, so that files
+   can be mapped by `gghlite_enc_arena_mmap`.
+
+   @return 0 on success, -1 on failure
+
+   @ingroup io
+*/
+
+int gghlite_enc_arena_fwrite(FILE *fp, const gghlite_enc_arena_t op);
+
+/**
+   @brief Map an arena of encodings written by `gghlite_enc_arena_fwrite` into memory.
+
+   The file is mapped privately, so no parsing or copying takes place and all `gghlite_enc_arena_*`
+   functions operate directly on the mapped slots. Modified pages are copied on write and never
+   reach the file. Clear with `gghlite_enc_arena_clear`.
+
+   @param op        uninitialised arena
+   @param self      GGHLite `params` the encodings belong to
+   @param filename  file name
+   @return 0 on success, -1 if the file cannot be mapped or does not match `self`
+
+   @ingroup io
+*/
+
+int gghlite_enc_arena_mmap(gghlite_enc_arena_t op, const gghlite_params_t self, const char *filename);
+
+/**
+   @defgroup circuit Circuit Evaluation
+
+   Circuits are DAGs of additions, subtractions, multiplications and zero-tests over encodings.
+   Nodes are added one by one and refer to earlier nodes by the index returned when they were
+   added. `gghlite_circuit_compile` checks levels, fuses trees of single-use additions and
+   multiplications into inner products, which reduce each slot modulo $q$ once, and groups
+   independent nodes into layers which are evaluated in parallel. Intermediate results are
+   released as soon as the last layer reading them has been evaluated.
+*/
+
+/**
+   @brief Initialise an empty circuit over encodings for `params`.
+
+   @param self      uninitialised circuit
+   @param params    initialised GGHLite `params`, must outlive `self`
+
+   @ingroup circuit
+*/
+
+void gghlite_circuit_init(gghlite_circuit_t self, const gghlite_params_t params);
+
+/**
+   @brief Clear circuit.
+
+   @ingroup circuit
+*/
+
+void gghlite_circuit_clear(gghlite_circuit_t self);
+
+/**
+   @brief Add an input encoding at level-$k$ in group `group`, return its node.
+
+   Inputs are numbered in the order they are added, see `gghlite_circuit_eval`.
+
+   @param self      initialised circuit
+   @param k         level, must be at most 1 for asymmetric instances
+   @param group     array of length $γ$, ignored for symmetric instances
+
+   @ingroup circuit
+*/
+
+size_t gghlite_circuit_input(gghlite_circuit_t self, const size_t k, const int *group);
+
+/**
+   @brief Add node computing $a + b$, return its node.
+
+   Operands must be earlier nodes which are not zero-tests.
+
+   @ingroup circuit
+*/
+
+size_t gghlite_circuit_add(gghlite_circuit_t self, const size_t a, const size_t b);
+
+/**
+   @brief Add node computing $a - b$, return its node.
+
+   Operands must be earlier nodes which are not zero-tests.
+
+   @ingroup circuit
+*/
+
+size_t gghlite_circuit_sub(gghlite_circuit_t self, const size_t a, const size_t b);
+
+/**
+   @brief Add node computing $a · b$, return its node.
+
+   Operands must be earlier nodes which are not zero-tests.
+
+   @ingroup circuit
+*/
+
+size_t gghlite_circuit_mul(gghlite_circuit_t self, const size_t a, const size_t b);
+
+/**
+   @brief Add node zero-testing $a$, return its node.
+
+   Zero-tests are numbered in the order they are added, see `gghlite_circuit_eval`.
+   The operand must be an earlier node which is not a zero-test.
+
+   @ingroup circuit
+*/
+
+size_t gghlite_circuit_is_zero(gghlite_circuit_t self, const size_t a);
+
+/**
+   @brief Mark node $a$ as output and return its output index.
+
+   @ingroup circuit
+*/
+
+size_t gghlite_circuit_output(gghlite_circuit_t self, const size_t a);
+
+/**
+   @brief Check and schedule circuit.
+
+   Levels are propagated from the inputs: sums require equal levels, products add levels, no level
+   may exceed $κ$ (at most one $z_i$ per group for asymmetric instances) and zero-tests require
+   level $κ$. Adding nodes after compiling discards the schedule.
+
+   @param self      initialised circuit
+   @return 0 on success, -1 if levels are inconsistent, in which case `self->error` holds the first
+           offending node
+
+   @ingroup circuit
+*/
+
+int gghlite_circuit_compile(gghlite_circuit_t self);
+
+/**
+   @brief Evaluate circuit on `in`.
+
+   @param out       array of initialised encodings, one per output, return value
+   @param is_zero   array with one entry per zero-test, return value
+   @param self      initialised circuit, compiled if necessary
+   @param in        array of valid encodings, one per input, at the levels declared
+   @return 0 on success, -1 if `self` does not compile
+
+   @ingroup circuit
+*/
+
+int gghlite_circuit_eval(gghlite_enc_t *out, int *is_zero, gghlite_circuit_t self, gghlite_enc_t *in);
+
+/**
+   @defgroup server Encoding Service
+
+   A secret key can be served to local clients over a Unix domain socket, so that short-lived jobs
+   do not have to run instance generation themselves. Requests from all connected clients which
+   are ready at the same time are processed as one batch: encodings are produced by
+   `gghlite_enc_set_gghlite_clr_batch`, products in parallel and zero-tests by
+   `gghlite_enc_is_zero_batch`. Each response reports the time the request spent in the server.
+*/
+
+/**
+   @brief Serve requests for `self` on the Unix domain socket `path` until a client requests a
+   shutdown.
+
+   @param self      initialised GGHLite secret key
+   @param path      file name of socket, a stale socket is replaced but any other existing file
+                    makes this function fail
+   @param max_batch maximum number of requests processed together
+   @return 0 after a shutdown request, -1 on failure
+
+   @ingroup server
+*/
+
+int gghlite_server_run(const gghlite_sk_t self, const char *path, size_t max_batch);
+
+/**
+   @brief Connect to the server listening on `path`, return a file descriptor or -1.
+
+   @ingroup server
+*/
+
+int gghlite_client_connect(const char *path);
+
+/**
+   @brief Encode $f$ at level-$k$ in group `group` using the server connected to on `fd`.
+
+   @param rop       initialised encoding, return value
+   @param fd        connection returned by `gghlite_client_connect`
+   @param self      GGHLite `params` of the server's secret key
+   @param f         an element in $\\ZZ[x]/(x^n+1)$
+   @param k         target level $0 ≤ k ≤ κ$
+   @param group     array of length $γ$
+   @param rerand    flag controlling if re-randomisation is run after raising
+   @param latency   if not `NULL`, time the request spent in the server in μs
+   @return 0 on success, -1 on failure
+
+   @ingroup server
+*/
+
+int gghlite_client_enc_set_gghlite_clr(gghlite_enc_t rop, int fd, const gghlite_params_t self,
+                                       const gghlite_clr_t f, const size_t k, const int *group,
+                                       const int rerand, uint64_t *latency);
+
+/**
+   @brief Compute $h = f·g$ using the server connected to on `fd`.
+
+   @return 0 on success, -1 on failure
+
+   @ingroup server
+*/
+
+int gghlite_client_enc_mul(gghlite_enc_t h, int fd, const gghlite_params_t self,
+                           const gghlite_enc_t f, const gghlite_enc_t g, uint64_t *latency);
+
+/**
+   @brief Zero-test $f$ using the server connected to on `fd`.
+
+   @return 1 if $f$ is an encoding of zero, 0 if not, -1 on failure
+
+   @ingroup server
+*/
+
+int gghlite_client_enc_is_zero(int fd, const gghlite_params_t self, const gghlite_enc_t op, uint64_t *latency);
+
+/**
+   @brief Ask the server connected to on `fd` to stop.
+
+   @return 0 on success, -1 on failure
+
+   @ingroup server
+*/
+
+int gghlite_client_shutdown(int fd);
+
+/**
+   @defgroup async Asynchronous Operations
+
+   Long running operations can be started on their own thread and return a future. Cancellation
+   is cooperative: the rejection loop sampling $g$, the steps of instance generation and the
+   reductions modulo $\\ideal{g}$ poll the cancellation flag of the future and return early. The
+   outputs of a cancelled operation must be discarded.
+*/
+
+/**
+   @brief Run `gghlite_init` on a new thread.
+
+   If cancelled, `self` is cleared before the future completes.
+
+   @param fut       uninitialised future
+   @param self      secret key, return value, must not be accessed until `fut` completed
+
+   @ingroup async
+*/
+
+void gghlite_init_async(gghlite_future_t fut, gghlite_sk_t self, const size_t lambda, const size_t kappa,
+                        const size_t gamma, const uint64_t rerand_mask, const gghlite_flag_t flags,
+                        aes_randstate_t randstate);
+
+/**
+   @brief Run `gghlite_enc_set_gghlite_clr` on a new thread.
+
+   All arguments must remain valid until `fut` completed.
+
+   @ingroup async
+*/
+
+void gghlite_enc_set_gghlite_clr_async(gghlite_future_t fut, gghlite_enc_t rop, const gghlite_sk_t self,
+                                       const gghlite_clr_t f, const size_t k, int *group, const int rerand);
+
+/**
+   @brief Run `gghlite_enc_is_zero` on a new thread, see `gghlite_future_result`.
+
+   @ingroup async
+*/
+
+void gghlite_enc_is_zero_async(gghlite_future_t fut, const gghlite_params_t self, const gghlite_enc_t op);
+
+/**
+   @brief Return state of `fut` without blocking.
+
+   @ingroup async
+*/
+
+gghlite_future_state_t gghlite_future_poll(gghlite_future_t fut);
+
+/**
+   @brief Wait until `fut` completes or `timeout` μs passed and return its state.
+
+   @param fut       future
+   @param timeout   timeout in μs, zero to wait indefinitely
+
+   @ingroup async
+*/
+
+gghlite_future_state_t gghlite_future_wait(gghlite_future_t fut, const uint64_t timeout);
+
+/**
+   @brief Request cancellation of `fut`, use `gghlite_future_wait` to wait for it to stop.
+
+   An operation which finishes before it observes the request completes as
+   `GGHLITE_FUTURE_DONE`, its outputs are then valid.
+
+   @ingroup async
+*/
+
+void gghlite_future_cancel(gghlite_future_t fut);
+
+/**
+   @brief Wait for `fut` and return the result of its operation, e.g. of `gghlite_enc_is_zero`.
+
+   @ingroup async
+*/
+
+int gghlite_future_result(gghlite_future_t fut);
+
+/**
+   @brief Clear `fut`, cancelling and waiting for it if it has not been waited for.
+
+   @ingroup async
+*/
+
+void gghlite_future_clear(gghlite_future_t fut);
+
 #ifdef __cplusplus
 }
 #endif
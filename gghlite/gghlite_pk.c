@@ -19,6 +19,32 @@ gghlite_params_initzero(gghlite_params_t self, size_t lambda, size_t kappa,
     mpfr_init2(self->ell_b, _gghlite_prec(self));
     mpfr_init2(self->sigma_s, _gghlite_prec(self));
     mpfr_init2(self->xi, _gghlite_prec(self));
+    fmpz_init(self->zero_bound);
+}
+
+void
+_gghlite_params_set_zero_bound(gghlite_params_t self)
+{
+    assert(!fmpz_is_zero(self->q));
+
+    mpfr_t bound, ex;
+    mpfr_init2(bound, _gghlite_prec(self));
+    mpfr_init2(ex, _gghlite_prec(self));
+
+    /* q^{2(1-ξ)} */
+    _gghlite_params_get_q_mpfr(bound, self, MPFR_RNDN);
+    mpfr_ui_sub(ex, 1, self->xi, MPFR_RNDN);
+    mpfr_mul_ui(ex, ex, 2, MPFR_RNDN);
+    mpfr_pow(bound, bound, ex, MPFR_RNDN);
+
+    mpz_t bound_z;
+    mpz_init(bound_z);
+    mpfr_get_z(bound_z, bound, MPFR_RNDD);
+    fmpz_set_mpz(self->zero_bound, bound_z);
+    mpz_clear(bound_z);
+
+    mpfr_clear(ex);
+    mpfr_clear(bound);
 }
 
 static void
@@ -107,6 +133,16 @@ _gghlite_params_set_q(gghlite_params_t self)
     mpfr_clear(log_q_base);
     mpfr_clear(q_base);
 
+    if (self->flags & GGHLITE_FLAGS_RNS) {
+        /* q = ∏ p_i ≥ 2^{⌈log q⌉} with word-sized p_i ≡ 1 mod 2n */
+        const mp_bitcnt_t bits = fmpz_sizeinbase(self->q, 2) + 1;
+        if (self->rns->k)
+            fmpz_oz_rns_clear(self->rns);
+        fmpz_oz_rns_init(self->rns, self->n, bits);
+        fmpz_set(self->q, self->rns->q);
+        return;
+    }
+
     fmpz_fdiv_q_2exp(self->q, self->q, n_flog(self->n,2)+1);
     fmpz_mul_2exp(self->q, self->q, n_flog(self->n,2)+1);
     fmpz_add_ui(self->q, self->q, 1);
@@ -349,6 +385,8 @@ _gghlite_params_set_ell_b(gghlite_params_t self)
    - @f$σ^* ≥ n^{1.5}·ℓ_g·σ'·\sqrt{2·\log(4nε_ρ^{-1})/π}@f$, cf. [LSS14]_, p.17, Eq. (8)
    - @f$σ^* ≥ n^{1.5}·(σ')²\sqrt{8πε_d^{-1}}/ℓ_b@f$, cf. [LSS14]_, p.17, Eq. (9) with
    @f$εₑ^{-1} = O(\log λ/κ)@f$.
+
+   @note This is the width at level one, see `_gghlite_params_get_sigma_s` for higher levels.
 */
 static void
 _gghlite_params_set_sigma_s(gghlite_params_t self)
@@ -357,8 +395,8 @@ _gghlite_params_set_sigma_s(gghlite_params_t self)
         /* if there is no re-randomisation there is not σ^* */
         mpfr_set_d(self->sigma_s, 1.0, MPFR_RNDN);
         return;
-    } else if (self->rerand_mask != 1) {
-        ggh_die("Re-randomisation at higher levels is not implemented yet.");
+    } else if (!gghlite_params_is_symmetric(self) && (self->rerand_mask & ~(uint64_t)1)) {
+        ggh_die("Re-randomisation at higher levels requires a symmetric instance.");
     }
 
     assert(self->kappa > 0);
@@ -440,6 +478,25 @@ _gghlite_params_set_sigma_s(gghlite_params_t self)
     mpfr_clear(sigma_s0);
 }
 
+void
+_gghlite_params_get_sigma_s(mpfr_t rop, const gghlite_params_t self, const size_t k)
+{
+    assert(k >= 1);
+
+    /* numerators of level-k encodings grow by a factor of about sqrt(n)·σ' per level. The bound on q
+       already accounts for k level-1 factors of width σ^*, which dominates σ^* · (sqrt(n)·σ')^(k-1). */
+
+    mpfr_t tmp;
+    mpfr_init2(tmp, _gghlite_prec(self));
+    mpfr_set_ui(tmp, self->n, MPFR_RNDN);
+    mpfr_sqrt(tmp, tmp, MPFR_RNDN);
+    mpfr_mul(tmp, tmp, self->sigma_p, MPFR_RNDN); // sqrt(n)·σ'
+    mpfr_pow_ui(tmp, tmp, k-1, MPFR_RNDN);
+    mpfr_set_prec(rop, _gghlite_prec(self));
+    mpfr_mul(rop, self->sigma_s, tmp, MPFR_RNDN); // σ^* · (sqrt(n)·σ')^(k-1)
+    mpfr_clear(tmp);
+}
+
 double gghlite_params_get_delta_0(const gghlite_params_t self) {
 
     /* Finding a short d·g in <g> */
@@ -578,6 +635,7 @@ gghlite_params_init_gamma(gghlite_params_t self, size_t lambda, size_t kappa,
         _gghlite_params_set_ell_g(self);
         _gghlite_params_set_ell(self);
         _gghlite_params_set_sigma_p(self);
+        _gghlite_params_set_ell_b(self);
         _gghlite_params_set_sigma_s(self);
         _gghlite_params_set_q(self);
 
@@ -592,22 +650,90 @@ gghlite_params_init_gamma(gghlite_params_t self, size_t lambda, size_t kappa,
     print_timer();
     timer_printf("\n");
 
+    _gghlite_params_set_zero_bound(self);
+
     if (self->flags & GGHLITE_FLAGS_VERBOSE)
         gghlite_params_print(self);
 }
 
+void
+_gghlite_params_init_x(gghlite_params_t self, const size_t len)
+{
+    assert(!fmpz_is_zero(self->q));
+
+    const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+
+    self->x_len = len;
+    self->x = calloc(bound, sizeof(gghlite_enc_t **));
+    for(size_t i=0; i<bound; i++) {
+        self->x[i] = calloc(self->kappa, sizeof(gghlite_enc_t *));
+        for(size_t k=0; k<self->kappa; k++) {
+            if (!gghlite_params_have_rerand(self, k))
+                continue;
+            self->x[i][k] = calloc(len, sizeof(gghlite_enc_t));
+            for(size_t j=0; j<len; j++)
+                gghlite_enc_init(self->x[i][k][j], self);
+        }
+    }
+
+    /* σ^*_k does not depend on the group, one sampler per level */
+    mpfr_t sigma_s;
+    mpfr_init2(sigma_s, _gghlite_prec(self));
+    self->D_sigma_s = calloc(self->kappa, sizeof(dgsl_rot_mp_t *));
+    for(size_t k=0; k<self->kappa; k++) {
+        if (!gghlite_params_have_rerand(self, k))
+            continue;
+        _gghlite_params_get_sigma_s(sigma_s, self, k+1);
+        self->D_sigma_s[k] = _gghlite_dgsl_from_n(self->n, sigma_s, 0);
+    }
+    mpfr_clear(sigma_s);
+}
+
+static void
+_gghlite_params_clear_x(gghlite_params_t self)
+{
+    const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+
+    for(size_t i=0; i<bound; i++) {
+        for(size_t k=0; k<self->kappa; k++) {
+            if (!self->x[i][k])
+                continue;
+            for(size_t j=0; j<self->x_len; j++)
+                gghlite_enc_clear(self->x[i][k][j]);
+            free(self->x[i][k]);
+        }
+        free(self->x[i]);
+    }
+    free(self->x);
+
+    for(size_t k=0; k<self->kappa; k++) {
+        if (self->D_sigma_s[k])
+            dgsl_rot_mp_clear(self->D_sigma_s[k]);
+    }
+    free(self->D_sigma_s);
+    self->D_sigma_s = NULL;
+    self->x = NULL;
+    self->x_len = 0;
+}
+
 void
 gghlite_params_clear(gghlite_params_t self)
 {
+    if (self->x)
+        _gghlite_params_clear_x(self);
     fmpz_mod_poly_clear(self->pzt);
 
+    fmpz_clear(self->zero_bound);
     mpfr_clear(self->xi);
     mpfr_clear(self->sigma_s);
     mpfr_clear(self->ell_b);
     mpfr_clear(self->sigma_p);
     mpfr_clear(self->ell_g);
     mpfr_clear(self->sigma);
-    fmpz_mod_poly_oz_ntt_precomp_clear(self->ntt);
+    if (self->ntt)
+        fmpz_mod_poly_oz_ntt_precomp_unref(self->ntt);
+    if (self->rns->k)
+        fmpz_oz_rns_clear(self->rns);
     fmpz_clear(self->q);
 }
 
@@ -716,10 +842,11 @@ gghlite_params_print(const gghlite_params_t self)
         if (gghlite_params_have_rerand(self, k))
             count++;
 
+    /* p_zt and a pool of encodings of zero per level and source group */
     if (gghlite_params_is_symmetric(self))
-        mpfr_mul_ui(par, par, count*2 + 1 + 1, MPFR_RNDN);
+        mpfr_mul_ui(par, par, count*GGHLITE_RERAND_POOL_SIZE + 1, MPFR_RNDN);
     else
-        mpfr_mul_ui(par, par, count*3 + 1, MPFR_RNDN);
+        mpfr_mul_ui(par, par, self->gamma*count*GGHLITE_RERAND_POOL_SIZE + 1, MPFR_RNDN);
 
     mpfr_get_d(par, MPFR_RNDN);
     sd = mpfr_get_d(par, MPFR_RNDN)/8.0;
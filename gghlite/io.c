@@ -0,0 +1,462 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gghlite-internals.h"
+#include "gghlite.h"
+
+/**
+   Every file starts with this header. All integers are stored in the byte order of the writer,
+   which is recorded in `endian` so that readers on a different architecture fail cleanly.
+*/
+
+struct _gghlite_io_header {
+    char magic[8];        //!< `GGHLITE_IO_MAGIC`
+    uint32_t version;     //!< `GGHLITE_IO_VERSION`
+    uint32_t endian;      //!< `GGHLITE_IO_ENDIAN` as written by the writer
+    uint32_t type;        //!< one of `GGHLITE_IO_PARAMS` or `GGHLITE_IO_ENCODINGS`
+    uint32_t limb_bits;   //!< `FLINT_BITS` of the writer
+};
+
+#define GGHLITE_IO_MAGIC    "GGHLITE"
+#define GGHLITE_IO_VERSION  3
+#define GGHLITE_IO_ENDIAN   0x01020304
+#define GGHLITE_IO_PARAMS    1
+#define GGHLITE_IO_ENCODINGS 2
+
+/** Slots of encoding arrays start at a multiple of this many bytes. */
+
+#define GGHLITE_IO_ALIGN 4096
+
+static int
+_gghlite_io_write_header(FILE *fp, const uint32_t type)
+{
+    struct _gghlite_io_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GGHLITE_IO_MAGIC, sizeof(GGHLITE_IO_MAGIC));
+    header.version = GGHLITE_IO_VERSION;
+    header.endian = GGHLITE_IO_ENDIAN;
+    header.type = type;
+    header.limb_bits = FLINT_BITS;
+    return (fwrite(&header, sizeof(header), 1, fp) == 1) ? 0 : -1;
+}
+
+static int
+_gghlite_io_check_header(const struct _gghlite_io_header *header, const uint32_t type)
+{
+    if (memcmp(header->magic, GGHLITE_IO_MAGIC, sizeof(GGHLITE_IO_MAGIC)) != 0)
+        return -1;
+    if (header->version != GGHLITE_IO_VERSION)
+        return -1;
+    if (header->endian != GGHLITE_IO_ENDIAN)
+        return -1;
+    if (header->type != type || header->limb_bits != FLINT_BITS)
+        return -1;
+    return 0;
+}
+
+int
+_gghlite_io_write_u64(FILE *fp, const uint64_t x)
+{
+    return (fwrite(&x, sizeof(uint64_t), 1, fp) == 1) ? 0 : -1;
+}
+
+int
+_gghlite_io_read_u64(uint64_t *x, FILE *fp)
+{
+    return (fread(x, sizeof(uint64_t), 1, fp) == 1) ? 0 : -1;
+}
+
+/** Integers are stored as their signed limb count followed by their absolute value. */
+
+int
+_gghlite_io_write_fmpz(FILE *fp, const fmpz_t x)
+{
+    mpz_t z;
+    int r = 0;
+    mpz_init(z);
+    fmpz_get_mpz(z, x);
+    r |= _gghlite_io_write_u64(fp, (uint64_t)(int64_t)z->_mp_size);
+    const size_t size = FLINT_ABS(z->_mp_size);
+    if (size && fwrite(z->_mp_d, sizeof(mp_limb_t), size, fp) != size)
+        r = -1;
+    mpz_clear(z);
+    return r;
+}
+
+int
+_gghlite_io_read_fmpz(fmpz_t x, FILE *fp, size_t *avail)
+{
+    uint64_t size_;
+    if (*avail < sizeof(uint64_t) || _gghlite_io_read_u64(&size_, fp))
+        return -1;
+    *avail -= sizeof(uint64_t);
+    const int64_t size = (int64_t)size_;
+    const uint64_t abs_size = (size < 0) ? -(uint64_t)size : (uint64_t)size;
+
+    /* the limb count is untrusted: it must fit into the input and into an mpz */
+    if (abs_size > *avail / sizeof(mp_limb_t) || abs_size > INT_MAX / FLINT_BITS)
+        return -1;
+
+    mpz_t z;
+    mpz_init2(z, FLINT_MAX(abs_size, 1) * FLINT_BITS);
+    if (abs_size && fread(z->_mp_d, sizeof(mp_limb_t), abs_size, fp) != abs_size) {
+        mpz_clear(z);
+        return -1;
+    }
+    *avail -= abs_size * sizeof(mp_limb_t);
+
+    /* writers never produce leading zero limbs, but do not rely on it */
+    size_t top = abs_size;
+    while(top && z->_mp_d[top-1] == 0)
+        top--;
+    z->_mp_size = (size < 0) ? -(int)top : (int)top;
+    fmpz_set_mpz(x, z);
+    mpz_clear(z);
+    return 0;
+}
+
+int
+_gghlite_io_write_fmpz_vec(FILE *fp, const fmpz *vec, const size_t len, const size_t n)
+{
+    int r = _gghlite_io_write_u64(fp, n);
+    for(size_t i=0; i<n; i++) {
+        if (i < len)
+            r |= _gghlite_io_write_fmpz(fp, vec + i);
+        else
+            r |= _gghlite_io_write_u64(fp, 0);
+    }
+    return r;
+}
+
+int
+_gghlite_io_read_fmpz_mod_poly(fmpz_mod_poly_t rop, const size_t n, FILE *fp, size_t *avail)
+{
+    uint64_t len;
+    if (*avail < sizeof(uint64_t) || _gghlite_io_read_u64(&len, fp))
+        return -1;
+    *avail -= sizeof(uint64_t);
+    /* every coefficient takes at least one word */
+    if (len > n || len > *avail / sizeof(uint64_t))
+        return -1;
+    int r = 0;
+    fmpz_mod_poly_fit_length(rop, len);
+    for(size_t i=0; !r && i<len; i++) {
+        r |= _gghlite_io_read_fmpz(rop->coeffs + i, fp, avail);
+        if (!r && (fmpz_sgn(rop->coeffs + i) < 0 || fmpz_cmp(rop->coeffs + i, &rop->p) >= 0))
+            r = -1;
+    }
+    if (r) {
+        fmpz_mod_poly_zero(rop);
+        return r;
+    }
+    _fmpz_mod_poly_set_length(rop, len);
+    _fmpz_mod_poly_normalise(rop);
+    return r;
+}
+
+int
+_gghlite_io_read_fmpz_poly(fmpz_poly_t rop, const size_t n, FILE *fp, size_t *avail)
+{
+    uint64_t len;
+    if (*avail < sizeof(uint64_t) || _gghlite_io_read_u64(&len, fp))
+        return -1;
+    *avail -= sizeof(uint64_t);
+    if (len > n || len > *avail / sizeof(uint64_t))
+        return -1;
+    int r = 0;
+    fmpz_poly_fit_length(rop, len);
+    for(size_t i=0; !r && i<len; i++)
+        r |= _gghlite_io_read_fmpz(rop->coeffs + i, fp, avail);
+    if (r) {
+        fmpz_poly_zero(rop);
+        return r;
+    }
+    _fmpz_poly_set_length(rop, len);
+    _fmpz_poly_normalise(rop);
+    return r;
+}
+
+/**
+   Return the number of bytes left in `fp` if it is a regular file, `SIZE_MAX` otherwise.
+*/
+
+static size_t
+_gghlite_io_avail(FILE *fp)
+{
+    struct stat st;
+    const long pos = ftell(fp);
+    if (pos < 0 || fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < pos)
+        return SIZE_MAX;
+    return (size_t)(st.st_size - pos);
+}
+
+/** Floating point values are stored exactly as precision, mantissa and exponent. */
+
+static int
+_gghlite_io_write_mpfr(FILE *fp, const mpfr_t x)
+{
+    mpz_t m;
+    fmpz_t m_;
+    int r = 0;
+    mpz_init(m);
+    fmpz_init(m_);
+    const mpfr_exp_t e = mpfr_get_z_2exp(m, x);
+    fmpz_set_mpz(m_, m);
+    r |= _gghlite_io_write_u64(fp, (uint64_t)mpfr_get_prec(x));
+    r |= _gghlite_io_write_u64(fp, (uint64_t)(int64_t)e);
+    r |= _gghlite_io_write_fmpz(fp, m_);
+    fmpz_clear(m_);
+    mpz_clear(m);
+    return r;
+}
+
+static int
+_gghlite_io_read_mpfr(mpfr_t x, FILE *fp, size_t *avail)
+{
+    uint64_t prec, e;
+    if (*avail < 2*sizeof(uint64_t) || _gghlite_io_read_u64(&prec, fp) || _gghlite_io_read_u64(&e, fp))
+        return -1;
+    *avail -= 2*sizeof(uint64_t);
+    if (prec < (uint64_t)MPFR_PREC_MIN || prec > (uint64_t)MPFR_PREC_MAX)
+        return -1;
+
+    fmpz_t m_;
+    mpz_t m;
+    fmpz_init(m_);
+    mpz_init(m);
+    int r = _gghlite_io_read_fmpz(m_, fp, avail);
+    fmpz_get_mpz(m, m_);
+    mpfr_set_prec(x, (mpfr_prec_t)prec);
+    mpfr_set_z_2exp(x, m, (mpfr_exp_t)(int64_t)e, MPFR_RNDN);
+    mpz_clear(m);
+    fmpz_clear(m_);
+    return r;
+}
+
+int
+gghlite_params_fwrite(FILE *fp, const gghlite_params_t self)
+{
+    assert(self->ntt);
+    int r = _gghlite_io_write_header(fp, GGHLITE_IO_PARAMS);
+
+    r |= _gghlite_io_write_u64(fp, self->lambda);
+    r |= _gghlite_io_write_u64(fp, self->gamma);
+    r |= _gghlite_io_write_u64(fp, self->kappa);
+    r |= _gghlite_io_write_u64(fp, self->rerand_mask);
+    r |= _gghlite_io_write_u64(fp, (uint64_t)self->flags);
+    r |= _gghlite_io_write_u64(fp, (uint64_t)self->n);
+    r |= _gghlite_io_write_u64(fp, (uint64_t)self->ell);
+    r |= _gghlite_io_write_fmpz(fp, self->q);
+
+    /* store φ, so readers skip root finding and obtain the same slot order */
+    r |= _gghlite_io_write_fmpz(fp, self->ntt->phi);
+
+    r |= _gghlite_io_write_mpfr(fp, self->sigma);
+    r |= _gghlite_io_write_mpfr(fp, self->sigma_p);
+    r |= _gghlite_io_write_mpfr(fp, self->sigma_s);
+    r |= _gghlite_io_write_mpfr(fp, self->ell_b);
+    r |= _gghlite_io_write_mpfr(fp, self->ell_g);
+    r |= _gghlite_io_write_mpfr(fp, self->xi);
+
+    r |= _gghlite_io_write_fmpz_vec(fp, self->pzt->coeffs, self->pzt->length, self->n);
+
+    /* pools of encodings of zero for re-randomisation */
+    r |= _gghlite_io_write_u64(fp, self->x_len);
+    const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+    for(size_t i=0; i<bound && self->x; i++)
+        for(size_t k=0; k<self->kappa; k++)
+            for(size_t j=0; self->x[i][k] && j<self->x_len; j++)
+                r |= _gghlite_io_write_fmpz_vec(fp, self->x[i][k][j]->coeffs, self->x[i][k][j]->length, self->n);
+    return r;
+}
+
+int
+gghlite_params_fread(gghlite_params_t self, FILE *fp)
+{
+    struct _gghlite_io_header header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 || _gghlite_io_check_header(&header, GGHLITE_IO_PARAMS))
+        return -1;
+
+    uint64_t lambda, gamma, kappa, rerand_mask, flags, n, ell;
+    if (_gghlite_io_read_u64(&lambda, fp) || _gghlite_io_read_u64(&gamma, fp) ||
+        _gghlite_io_read_u64(&kappa, fp) || _gghlite_io_read_u64(&rerand_mask, fp) ||
+        _gghlite_io_read_u64(&flags, fp) || _gghlite_io_read_u64(&n, fp) ||
+        _gghlite_io_read_u64(&ell, fp))
+        return -1;
+
+    /* n is a power of two and p_zt alone takes n words, λ sets the floating point precision, κ and γ
+       size arrays of pointers */
+    size_t avail = _gghlite_io_avail(fp);
+    if (lambda == 0 || kappa == 0 || gamma == 0 || n < 2 || (n & (n-1)) || lambda > avail ||
+        lambda > (uint64_t)MPFR_PREC_MAX/2 || n > avail / sizeof(uint64_t) ||
+        kappa > avail / sizeof(uint64_t) || gamma > avail / sizeof(uint64_t))
+        return -1;
+
+    gghlite_params_initzero(self, lambda, kappa, gamma);
+    self->rerand_mask = rerand_mask;
+    self->flags = (gghlite_flag_t)flags;
+    self->n = n;
+    self->ell = ell;
+
+    int r = 0;
+    fmpz_t phi;
+    fmpz_init(phi);
+    fmpz_init(self->q);
+    r |= _gghlite_io_read_fmpz(self->q, fp, &avail);
+    r |= _gghlite_io_read_fmpz(phi, fp, &avail);
+
+    r |= _gghlite_io_read_mpfr(self->sigma, fp, &avail);
+    r |= _gghlite_io_read_mpfr(self->sigma_p, fp, &avail);
+    r |= _gghlite_io_read_mpfr(self->sigma_s, fp, &avail);
+    r |= _gghlite_io_read_mpfr(self->ell_b, fp, &avail);
+    r |= _gghlite_io_read_mpfr(self->ell_g, fp, &avail);
+    r |= _gghlite_io_read_mpfr(self->xi, fp, &avail);
+
+    /* φ must be a 2n-th root of unity, i.e. φ^n = -1, and extraction drops bits(q) - ℓ bits */
+    if (!r && fmpz_cmp_ui(self->q, 1) > 0) {
+        fmpz_t t;
+        fmpz_init(t);
+        if (fmpz_sgn(phi) < 0 || fmpz_cmp(phi, self->q) >= 0) {
+            r = -1;
+        } else {
+            fmpz_powm_ui(t, phi, n, self->q);
+            fmpz_add_ui(t, t, 1);
+            r = (fmpz_equal(t, self->q) && ell <= fmpz_sizeinbase(self->q, 2)) ? 0 : -1;
+        }
+        fmpz_clear(t);
+    }
+
+    if (r || fmpz_cmp_ui(self->q, 1) <= 0) {
+        fmpz_clear(phi);
+        gghlite_params_clear(self);
+        return -1;
+    }
+
+    fmpz_mod_poly_init(self->pzt, self->q);
+    r |= _gghlite_io_read_fmpz_mod_poly(self->pzt, self->n, fp, &avail);
+
+    uint64_t x_len = 0;
+    if (!r && avail >= sizeof(uint64_t)) {
+        r |= _gghlite_io_read_u64(&x_len, fp);
+        avail -= sizeof(uint64_t);
+    } else {
+        r = -1;
+    }
+    /* every encoding of zero takes at least n+1 words */
+    if (r == 0 && x_len) {
+        const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+        if (!rerand_mask || x_len > avail / ((n + 1) * sizeof(uint64_t)) ||
+            bound > avail / (kappa * sizeof(uint64_t)))
+            r = -1;
+    }
+    if (r == 0 && x_len) {
+        _gghlite_params_init_x(self, x_len);
+        const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+        for(size_t i=0; !r && i<bound; i++)
+            for(size_t k=0; !r && k<self->kappa; k++)
+                for(size_t j=0; !r && self->x[i][k] && j<self->x_len; j++)
+                    r |= _gghlite_io_read_fmpz_mod_poly(self->x[i][k][j], self->n, fp, &avail);
+    }
+
+    if (r == 0) {
+        /* the RNS basis is deterministic given the size of q */
+        if (self->flags & GGHLITE_FLAGS_RNS)
+            fmpz_oz_rns_init(self->rns, self->n, fmpz_sizeinbase(self->q, 2));
+        self->ntt = _fmpz_mod_poly_oz_ntt_precomp_ref(self->n, self->q, phi);
+        _gghlite_params_set_zero_bound(self);
+    } else {
+        gghlite_params_clear(self);
+    }
+    fmpz_clear(phi);
+    return r;
+}
+
+int
+gghlite_enc_arena_fwrite(FILE *fp, const gghlite_enc_arena_t op)
+{
+    int r = _gghlite_io_write_header(fp, GGHLITE_IO_ENCODINGS);
+    r |= _gghlite_io_write_u64(fp, op->len);
+    r |= _gghlite_io_write_u64(fp, op->n);
+    r |= _gghlite_io_write_u64(fp, op->limbs);
+    if (op->limbs && fwrite(op->q, sizeof(mp_limb_t), op->limbs, fp) != op->limbs)
+        r = -1;
+
+    /* pad so that slots are aligned in the mapping */
+    const size_t head = sizeof(struct _gghlite_io_header) + 3*sizeof(uint64_t) + op->limbs*sizeof(mp_limb_t);
+    const size_t offset = (head + GGHLITE_IO_ALIGN - 1) / GGHLITE_IO_ALIGN * GGHLITE_IO_ALIGN;
+    for(size_t i=head; i<offset; i++)
+        r |= (fputc(0, fp) == EOF) ? -1 : 0;
+
+    const size_t size = op->len * op->n * op->limbs;
+    if (size && fwrite(op->data, sizeof(mp_limb_t), size, fp) != size)
+        r = -1;
+    return r;
+}
+
+int
+gghlite_enc_arena_mmap(gghlite_enc_arena_t op, const gghlite_params_t self, const char *filename)
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct _gghlite_io_header) + 3*sizeof(uint64_t)) {
+        close(fd);
+        return -1;
+    }
+
+    /* private writable mapping: results written into the arena never reach the file */
+    void *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+
+    const struct _gghlite_io_header *header = (const struct _gghlite_io_header*)base;
+    const uint64_t *fields = (const uint64_t*)(header + 1);
+    const uint64_t len = fields[0], n = fields[1], limbs = fields[2];
+    mp_srcptr q = (mp_srcptr)(fields + 3);
+
+    if (_gghlite_io_check_header(header, GGHLITE_IO_ENCODINGS) ||
+        n != (uint64_t)self->n || limbs != fmpz_size(self->q) || limbs == 0) {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    /* n and limbs match params, len is only bounded by the file size */
+    const size_t head = sizeof(struct _gghlite_io_header) + 3*sizeof(uint64_t) + limbs*sizeof(mp_limb_t);
+    const size_t offset = (head + GGHLITE_IO_ALIGN - 1) / GGHLITE_IO_ALIGN * GGHLITE_IO_ALIGN;
+
+    if (offset > (size_t)st.st_size ||
+        len > ((size_t)st.st_size - offset) / (n * limbs * sizeof(mp_limb_t))) {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    mpz_t q_;
+    mpz_init(q_);
+    fmpz_get_mpz(q_, self->q);
+    const int same_q = (q_->_mp_size == (int)limbs) && (mpn_cmp(q_->_mp_d, q, limbs) == 0);
+    mpz_clear(q_);
+    if (!same_q) {
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    op->len = len;
+    op->n = n;
+    op->limbs = limbs;
+    op->q = (mp_ptr)flint_malloc(limbs * sizeof(mp_limb_t));
+    memcpy(op->q, q, limbs * sizeof(mp_limb_t));
+    op->data = (mp_ptr)((char*)base + offset);
+    op->size = st.st_size;
+    op->offset = offset;
+    op->mapped = 1;
+    return 0;
+}
@@ -0,0 +1,640 @@
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <omp.h>
+
+#include "gghlite-internals.h"
+#include "gghlite.h"
+
+/**
+   Requests and responses are a fixed size header followed by `len` bytes of payload. All integers
+   are in host byte order, both ends run on the same machine.
+*/
+
+struct _gghlite_server_request {
+    uint32_t op;          //!< one of `GGHLITE_SERVER_*`
+    uint32_t flags;       //!< `GGHLITE_SERVER_RERAND` for encoding requests
+    uint64_t id;          //!< chosen by the client, echoed in the response
+    uint64_t len;         //!< payload length in bytes
+};
+
+struct _gghlite_server_response {
+    uint32_t status;      //!< 0 on success, -1 if the request was malformed
+    uint32_t reserved;
+    uint64_t id;          //!< id of the request
+    uint64_t latency;     //!< time between reading the request and writing the response in μs
+    uint64_t len;         //!< payload length in bytes
+};
+
+#define GGHLITE_SERVER_ENCODE   1 //!< $k$, group, clear element → encoding
+#define GGHLITE_SERVER_MUL      2 //!< two encodings → their product
+#define GGHLITE_SERVER_IS_ZERO  3 //!< encoding → 0 or 1
+#define GGHLITE_SERVER_SHUTDOWN 4 //!< stop serving after the current batch
+
+#define GGHLITE_SERVER_RERAND   0x1
+
+/**
+   Clients which stall for longer than this many milliseconds in the middle of a request or
+   response are disconnected, so that they cannot block the other connections.
+*/
+
+#ifndef GGHLITE_SERVER_TIMEOUT
+#define GGHLITE_SERVER_TIMEOUT 1000
+#endif
+
+struct _gghlite_server_job {
+    int fd;
+    struct _gghlite_server_request request;
+    uint64_t t;           //!< wall time when the request was read
+    char *payload;
+    uint32_t status;
+    char *response;
+    size_t response_len;
+};
+
+static int
+_gghlite_read_full(int fd, void *buf, size_t len)
+{
+    char *p = buf;
+    while(len) {
+        ssize_t r = read(fd, p, len);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return -1;
+        p += r;
+        len -= r;
+    }
+    return 0;
+}
+
+static int
+_gghlite_write_full(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    while(len) {
+        ssize_t r = send(fd, p, len, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return -1;
+        p += r;
+        len -= r;
+    }
+    return 0;
+}
+
+/**
+   Open the payload of `job` for reading, `NULL` if it is empty.
+*/
+
+static FILE *
+_gghlite_server_job_open(struct _gghlite_server_job *job)
+{
+    if (job->request.len == 0)
+        return NULL;
+    return fmemopen(job->payload, job->request.len, "r");
+}
+
+/**
+   Read a word from a payload with `avail` bytes left.
+*/
+
+static int
+_gghlite_server_read_u64(uint64_t *x, FILE *fp, size_t *avail)
+{
+    if (*avail < sizeof(uint64_t) || _gghlite_io_read_u64(x, fp))
+        return -1;
+    *avail -= sizeof(uint64_t);
+    return 0;
+}
+
+/**
+   Return the largest payload a valid request can have, larger payloads are rejected.
+
+   An encoding takes $1 + n·(\mbox{limbs}(q)+1)$ words. Multiplications carry two of them,
+   encoding requests carry $k$, $γ$, the group and a clear element no larger than an encoding.
+*/
+
+static size_t
+_gghlite_server_max_payload(const gghlite_params_t params)
+{
+    const size_t enc = 1 + params->n * (fmpz_size(params->q) + 1);
+    return FLINT_MAX(2 * enc, 2 + params->gamma + enc) * sizeof(uint64_t);
+}
+
+static void
+_gghlite_server_job_respond_enc(struct _gghlite_server_job *job, const gghlite_enc_t op, const size_t n)
+{
+    FILE *fp = open_memstream(&job->response, &job->response_len);
+    if (_gghlite_io_write_fmpz_vec(fp, op->coeffs, op->length, n))
+        job->status = -1;
+    fclose(fp);
+}
+
+static void
+_gghlite_server_encode(const gghlite_sk_t self, struct _gghlite_server_job **jobs, const size_t len,
+                       const int rerand)
+{
+    const size_t n = self->params->n;
+    const size_t gamma = self->params->gamma;
+
+    gghlite_enc_t *rop = malloc(len * sizeof(gghlite_enc_t));
+    gghlite_clr_t *f = malloc(len * sizeof(gghlite_clr_t));
+    size_t *k = malloc(len * sizeof(size_t));
+    int **group = malloc(len * sizeof(int*));
+    struct _gghlite_server_job **ok = malloc(len * sizeof(struct _gghlite_server_job*));
+    size_t m = 0;
+
+    for(size_t i=0; i<len; i++) {
+        FILE *fp = _gghlite_server_job_open(jobs[i]);
+        size_t avail = jobs[i]->request.len;
+        uint64_t k_ = 0, gamma_ = 0, g = 0;
+        int r = (fp == NULL);
+
+        gghlite_clr_init(f[m]);
+        group[m] = calloc(gamma, sizeof(int));
+
+        if (!r)
+            r |= _gghlite_server_read_u64(&k_, fp, &avail) || _gghlite_server_read_u64(&gamma_, fp, &avail) ||
+                gamma_ != gamma;
+        for(size_t j=0; !r && j<gamma; j++) {
+            r |= _gghlite_server_read_u64(&g, fp, &avail);
+            group[m][j] = (g != 0);
+        }
+        if (!r)
+            r |= _gghlite_io_read_fmpz_poly(f[m], n, fp, &avail);
+        /* asymmetric instances do not support k > 1, reject rather than die */
+        if (!r && (k_ > self->params->kappa || (!gghlite_sk_is_symmetric(self) && k_ > 1)))
+            r = -1;
+        if (fp)
+            fclose(fp);
+
+        if (r) {
+            jobs[i]->status = -1;
+            gghlite_clr_clear(f[m]);
+            free(group[m]);
+            continue;
+        }
+        k[m] = k_;
+        gghlite_enc_init(rop[m], self->params);
+        ok[m++] = jobs[i];
+    }
+
+    gghlite_enc_set_gghlite_clr_batch(rop, self, f, m, k, group, rerand);
+
+#pragma omp parallel for
+    for(size_t i=0; i<m; i++)
+        _gghlite_server_job_respond_enc(ok[i], rop[i], n);
+
+    for(size_t i=0; i<m; i++) {
+        gghlite_enc_clear(rop[i]);
+        gghlite_clr_clear(f[i]);
+        free(group[i]);
+    }
+    free(ok);
+    free(group);
+    free(k);
+    free(f);
+    free(rop);
+}
+
+static void
+_gghlite_server_mul(const gghlite_sk_t self, struct _gghlite_server_job **jobs, const size_t len)
+{
+    const size_t n = self->params->n;
+
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i=0; i<len; i++) {
+        gghlite_enc_t a, b;
+        gghlite_enc_init(a, self->params);
+        gghlite_enc_init(b, self->params);
+
+        FILE *fp = _gghlite_server_job_open(jobs[i]);
+        size_t avail = jobs[i]->request.len;
+        int r = (fp == NULL);
+        if (!r)
+            r |= _gghlite_io_read_fmpz_mod_poly(a, n, fp, &avail) || _gghlite_io_read_fmpz_mod_poly(b, n, fp, &avail);
+        if (fp)
+            fclose(fp);
+
+        if (r) {
+            jobs[i]->status = -1;
+        } else {
+            gghlite_enc_mul(a, self->params, a, b);
+            _gghlite_server_job_respond_enc(jobs[i], a, n);
+        }
+        gghlite_enc_clear(a);
+        gghlite_enc_clear(b);
+    }
+}
+
+static void
+_gghlite_server_is_zero(const gghlite_sk_t self, struct _gghlite_server_job **jobs, const size_t len)
+{
+    const size_t n = self->params->n;
+
+    gghlite_enc_t *op = malloc(len * sizeof(gghlite_enc_t));
+    uint64_t *rop = calloc((len + 63)/64, sizeof(uint64_t));
+
+    for(size_t i=0; i<len; i++) {
+        gghlite_enc_init(op[i], self->params);
+        FILE *fp = _gghlite_server_job_open(jobs[i]);
+        size_t avail = jobs[i]->request.len;
+        if (fp == NULL || _gghlite_io_read_fmpz_mod_poly(op[i], n, fp, &avail))
+            jobs[i]->status = -1;
+        if (fp)
+            fclose(fp);
+    }
+
+    gghlite_enc_is_zero_batch(rop, NULL, self->params, op, len);
+
+    for(size_t i=0; i<len; i++) {
+        if (jobs[i]->status == 0) {
+            FILE *fp = open_memstream(&jobs[i]->response, &jobs[i]->response_len);
+            _gghlite_io_write_u64(fp, (rop[i/64]>>(i%64)) & 1);
+            fclose(fp);
+        }
+        gghlite_enc_clear(op[i]);
+    }
+    free(rop);
+    free(op);
+}
+
+/**
+   Process all requests in `jobs` grouped by operation, return 1 if a shutdown was requested.
+*/
+
+static int
+_gghlite_server_process(const gghlite_sk_t self, struct _gghlite_server_job *jobs, const size_t len)
+{
+    struct _gghlite_server_job **sel = malloc(len * sizeof(struct _gghlite_server_job*));
+    int shutdown = 0;
+    size_t m;
+
+    for(int rerand=0; rerand<2; rerand++) {
+        m = 0;
+        for(size_t i=0; i<len; i++)
+            if (jobs[i].request.op == GGHLITE_SERVER_ENCODE &&
+                !!(jobs[i].request.flags & GGHLITE_SERVER_RERAND) == rerand)
+                sel[m++] = jobs + i;
+        if (m)
+            _gghlite_server_encode(self, sel, m, rerand);
+    }
+
+    m = 0;
+    for(size_t i=0; i<len; i++)
+        if (jobs[i].request.op == GGHLITE_SERVER_MUL)
+            sel[m++] = jobs + i;
+    if (m)
+        _gghlite_server_mul(self, sel, m);
+
+    m = 0;
+    for(size_t i=0; i<len; i++)
+        if (jobs[i].request.op == GGHLITE_SERVER_IS_ZERO)
+            sel[m++] = jobs + i;
+    if (m)
+        _gghlite_server_is_zero(self, sel, m);
+
+    for(size_t i=0; i<len; i++) {
+        switch(jobs[i].request.op) {
+        case GGHLITE_SERVER_ENCODE:
+        case GGHLITE_SERVER_MUL:
+        case GGHLITE_SERVER_IS_ZERO:
+            break;
+        case GGHLITE_SERVER_SHUTDOWN:
+            shutdown = 1;
+            break;
+        default:
+            jobs[i].status = -1;
+        }
+    }
+
+    free(sel);
+    return shutdown;
+}
+
+static void _gghlite_server_write_job(struct _gghlite_server_job *job);
+
+/**
+   Read one request from `fd` into `job`, return -1 if the connection should be closed.
+*/
+
+static int
+_gghlite_server_read_job(struct _gghlite_server_job *job, int fd, const size_t max_payload)
+{
+    memset(job, 0, sizeof(struct _gghlite_server_job));
+    job->fd = fd;
+    if (_gghlite_read_full(fd, &job->request, sizeof(job->request)))
+        return -1;
+    job->t = ggh_walltime(0);
+    if (job->request.len > max_payload)
+        return -1;
+    if (job->request.len) {
+        job->payload = malloc(job->request.len);
+        if (job->payload == NULL) {
+            /* the payload cannot be skipped reliably, report the error and hang up */
+            job->status = -1;
+            _gghlite_server_write_job(job);
+            return -1;
+        }
+        if (_gghlite_read_full(fd, job->payload, job->request.len)) {
+            free(job->payload);
+            job->payload = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void
+_gghlite_server_write_job(struct _gghlite_server_job *job)
+{
+    struct _gghlite_server_response response;
+    memset(&response, 0, sizeof(response));
+    response.status = job->status;
+    response.id = job->request.id;
+    response.len = (job->status == 0) ? job->response_len : 0;
+    response.latency = ggh_walltime(job->t);
+
+    /* a client that went away is noticed by poll() in the next round */
+    if (_gghlite_write_full(job->fd, &response, sizeof(response)) == 0 && response.len)
+        _gghlite_write_full(job->fd, job->response, response.len);
+
+    free(job->payload);
+    free(job->response);
+}
+
+int
+gghlite_server_run(const gghlite_sk_t self, const char *path, size_t max_batch)
+{
+    if (max_batch == 0)
+        max_batch = 1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+    strcpy(addr.sun_path, path);
+
+    /* only replace a stale socket, never some other file that happens to live at path */
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode) || unlink(path) != 0)
+            return -1;
+    }
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0)
+        return -1;
+    if (bind(lfd, (struct sockaddr*)&addr, sizeof(addr)) || listen(lfd, SOMAXCONN)) {
+        close(lfd);
+        return -1;
+    }
+
+    size_t nfds = 1, alloc = 16;
+    struct pollfd *fds = calloc(alloc, sizeof(struct pollfd));
+    fds[0].fd = lfd;
+    fds[0].events = POLLIN;
+
+    struct _gghlite_server_job *jobs = malloc(max_batch * sizeof(struct _gghlite_server_job));
+    const size_t max_payload = _gghlite_server_max_payload(self->params);
+    const struct timeval timeout_tv = {GGHLITE_SERVER_TIMEOUT / 1000, (GGHLITE_SERVER_TIMEOUT % 1000) * 1000};
+    int status = 0, running = 1;
+
+    while(running) {
+        /* wait for the first request, then collect whatever else is ready without blocking */
+        size_t len = 0;
+        int timeout = -1;
+        while(len < max_batch) {
+            int r = poll(fds, nfds, timeout);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r < 0) {
+                status = -1;
+                running = 0;
+                break;
+            }
+            if (r == 0)
+                break;
+
+            if (fds[0].revents & POLLIN) {
+                int fd = accept(lfd, NULL, NULL);
+                if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout_tv, sizeof(timeout_tv)) ||
+                                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout_tv, sizeof(timeout_tv)))) {
+                    close(fd);
+                    fd = -1;
+                }
+                if (fd >= 0) {
+                    if (nfds == alloc) {
+                        alloc *= 2;
+                        fds = realloc(fds, alloc * sizeof(struct pollfd));
+                    }
+                    fds[nfds].fd = fd;
+                    fds[nfds].events = POLLIN;
+                    fds[nfds].revents = 0;
+                    nfds++;
+                }
+            }
+
+            for(size_t i=1; i<nfds && len < max_batch; i++) {
+                if (fds[i].fd < 0 || !fds[i].revents)
+                    continue;
+                if (!(fds[i].revents & POLLIN) || _gghlite_server_read_job(jobs + len, fds[i].fd, max_payload)) {
+                    close(fds[i].fd);
+                    fds[i].fd = -1;
+                    continue;
+                }
+                len++;
+            }
+
+            /* drop closed connections */
+            size_t j = 1;
+            for(size_t i=1; i<nfds; i++)
+                if (fds[i].fd >= 0)
+                    fds[j++] = fds[i];
+            nfds = j;
+
+            if (len)
+                timeout = 0;
+        }
+
+        if (len && _gghlite_server_process(self, jobs, len))
+            running = 0;
+
+        for(size_t i=0; i<len; i++)
+            _gghlite_server_write_job(jobs + i);
+    }
+
+    for(size_t i=1; i<nfds; i++)
+        close(fds[i].fd);
+    close(lfd);
+    unlink(path);
+    free(jobs);
+    free(fds);
+    return status;
+}
+
+int
+gghlite_client_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+   Send request and wait for its response, the payload of the response is returned in `out` which
+   must be freed by the caller.
+*/
+
+static int
+_gghlite_client_call(int fd, const uint32_t op, const uint32_t flags, const char *payload, const size_t len,
+                     char **out, size_t *out_len, uint64_t *latency)
+{
+    static uint64_t id = 0;
+
+    struct _gghlite_server_request request;
+    memset(&request, 0, sizeof(request));
+    request.op = op;
+    request.flags = flags;
+    request.id = __sync_fetch_and_add(&id, 1);
+    request.len = len;
+
+    if (_gghlite_write_full(fd, &request, sizeof(request)) || (len && _gghlite_write_full(fd, payload, len)))
+        return -1;
+
+    struct _gghlite_server_response response;
+    if (_gghlite_read_full(fd, &response, sizeof(response)) || response.id != request.id)
+        return -1;
+    if (latency)
+        *latency = response.latency;
+
+    *out = NULL;
+    *out_len = response.len;
+    if (response.len) {
+        *out = malloc(response.len);
+        if (_gghlite_read_full(fd, *out, response.len)) {
+            free(*out);
+            *out = NULL;
+            return -1;
+        }
+    }
+    return (response.status == 0) ? 0 : -1;
+}
+
+/**
+   Send request and parse an encoding from the response.
+*/
+
+static int
+_gghlite_client_call_enc(gghlite_enc_t rop, int fd, const gghlite_params_t self, const uint32_t op,
+                         const uint32_t flags, char *payload, const size_t len, uint64_t *latency)
+{
+    char *out;
+    size_t out_len;
+    int r = _gghlite_client_call(fd, op, flags, payload, len, &out, &out_len, latency);
+    if (r == 0) {
+        FILE *fp = fmemopen(out, out_len, "r");
+        size_t avail = out_len;
+        r = (fp == NULL) ? -1 : _gghlite_io_read_fmpz_mod_poly(rop, self->n, fp, &avail);
+        if (fp)
+            fclose(fp);
+    }
+    free(out);
+    return r;
+}
+
+int
+gghlite_client_enc_set_gghlite_clr(gghlite_enc_t rop, int fd, const gghlite_params_t self,
+                                   const gghlite_clr_t f, const size_t k, const int *group,
+                                   const int rerand, uint64_t *latency)
+{
+    char *payload;
+    size_t len;
+    FILE *fp = open_memstream(&payload, &len);
+    int r = _gghlite_io_write_u64(fp, k);
+    r |= _gghlite_io_write_u64(fp, self->gamma);
+    for(size_t i=0; i<self->gamma; i++)
+        r |= _gghlite_io_write_u64(fp, group[i] != 0);
+    r |= _gghlite_io_write_fmpz_vec(fp, f->coeffs, f->length, f->length);
+    fclose(fp);
+
+    if (r == 0)
+        r = _gghlite_client_call_enc(rop, fd, self, GGHLITE_SERVER_ENCODE, (rerand) ? GGHLITE_SERVER_RERAND : 0,
+                                     payload, len, latency);
+    free(payload);
+    return r;
+}
+
+int
+gghlite_client_enc_mul(gghlite_enc_t rop, int fd, const gghlite_params_t self,
+                       const gghlite_enc_t f, const gghlite_enc_t g, uint64_t *latency)
+{
+    char *payload;
+    size_t len;
+    FILE *fp = open_memstream(&payload, &len);
+    int r = _gghlite_io_write_fmpz_vec(fp, f->coeffs, f->length, self->n);
+    r |= _gghlite_io_write_fmpz_vec(fp, g->coeffs, g->length, self->n);
+    fclose(fp);
+
+    if (r == 0)
+        r = _gghlite_client_call_enc(rop, fd, self, GGHLITE_SERVER_MUL, 0, payload, len, latency);
+    free(payload);
+    return r;
+}
+
+int
+gghlite_client_enc_is_zero(int fd, const gghlite_params_t self, const gghlite_enc_t op, uint64_t *latency)
+{
+    char *payload;
+    size_t len;
+    FILE *fp = open_memstream(&payload, &len);
+    int r = _gghlite_io_write_fmpz_vec(fp, op->coeffs, op->length, self->n);
+    fclose(fp);
+
+    char *out = NULL;
+    size_t out_len = 0;
+    if (r == 0)
+        r = _gghlite_client_call(fd, GGHLITE_SERVER_IS_ZERO, 0, payload, len, &out, &out_len, latency);
+    free(payload);
+
+    uint64_t is_zero = 0;
+    if (r == 0) {
+        if (out_len == sizeof(uint64_t))
+            memcpy(&is_zero, out, sizeof(uint64_t));
+        else
+            r = -1;
+    }
+    free(out);
+    return (r == 0) ? (int)is_zero : -1;
+}
+
+int
+gghlite_client_shutdown(int fd)
+{
+    char *out = NULL;
+    size_t out_len = 0;
+    int r = _gghlite_client_call(fd, GGHLITE_SERVER_SHUTDOWN, 0, NULL, 0, &out, &out_len, NULL);
+    free(out);
+    return r;
+}
@@ -0,0 +1,177 @@
+#include <assert.h>
+#include <string.h>
+#include <omp.h>
+#include <sys/mman.h>
+#include "arena.h"
+#include "ntt.h"
+#include "util.h"
+
+static inline void _fmpz_get_oz_limbs(mp_ptr rop, const fmpz_t op, const size_t limbs) {
+  assert(fmpz_sgn(op) >= 0);
+  mpn_zero(rop, limbs);
+  if (!COEFF_IS_MPZ(*op)) {
+    rop[0] = (mp_limb_t)*op;
+  } else {
+    const __mpz_struct *z = COEFF_TO_PTR(*op);
+    assert((size_t)z->_mp_size <= limbs);
+    mpn_copyi(rop, z->_mp_d, z->_mp_size);
+  }
+}
+
+static inline void _fmpz_set_oz_limbs(fmpz_t rop, mp_srcptr op, const size_t limbs) {
+  mp_size_t size = limbs;
+  while (size > 0 && op[size-1] == 0)
+    size--;
+
+  if (size <= 1) {
+    fmpz_set_ui(rop, (size) ? op[0] : 0);
+  } else {
+    __mpz_struct *z = _fmpz_promote(rop);
+    if (z->_mp_alloc < size)
+      mpz_realloc2(z, size * FLINT_BITS);
+    mpn_copyi(z->_mp_d, op, size);
+    z->_mp_size = size;
+  }
+}
+
+void fmpz_mod_poly_oz_arena_init(fmpz_mod_poly_oz_arena_t op, const size_t len, const size_t n, const fmpz_t q,
+                                 const oz_flag_t flags) {
+  assert(fmpz_cmp_ui(q, 1) > 0);
+
+  op->len = len;
+  op->n = n;
+  op->limbs = fmpz_size(q);
+  op->q = (mp_ptr)flint_malloc(op->limbs * sizeof(mp_limb_t));
+  _fmpz_get_oz_limbs(op->q, q, op->limbs);
+
+  op->size = len * n * op->limbs * sizeof(mp_limb_t);
+  op->data = NULL;
+  op->offset = 0;
+  op->mapped = 0;
+
+#ifdef MADV_HUGEPAGE
+  if ((flags & OZ_HUGEPAGES) && op->size) {
+    const size_t huge_page = ((size_t)1)<<21;
+    const size_t size = (op->size + huge_page - 1) & ~(huge_page - 1);
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data != MAP_FAILED) {
+      /* this is only a hint, hence we ignore failures */
+      madvise(data, size, MADV_HUGEPAGE);
+      op->data = (mp_ptr)data;
+      op->size = size;
+      op->mapped = 1;
+    }
+  }
+#endif
+
+  if (!op->data) {
+    /* anonymous mappings are zero already */
+    op->data = (mp_ptr)calloc((op->size) ? op->size : 1, 1);
+    if (!op->data)
+      oz_die("Cannot allocate %zu bytes for %zu elements.\n", op->size, len);
+  }
+}
+
+void fmpz_mod_poly_oz_arena_clear(fmpz_mod_poly_oz_arena_t op) {
+  if (op->mapped)
+    munmap((char*)op->data - op->offset, op->size);
+  else
+    free(op->data);
+  op->data = NULL;
+  flint_free(op->q);
+  op->q = NULL;
+}
+
+void fmpz_mod_poly_oz_arena_set_fmpz_mod_poly(fmpz_mod_poly_oz_arena_t rop, const size_t i, const fmpz_mod_poly_t op) {
+  assert(i < rop->len);
+  const size_t n = rop->n;
+
+#pragma omp parallel for if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  for(size_t j=0; j<n; j++) {
+    mp_ptr r = fmpz_mod_poly_oz_arena_slot(rop, i, j);
+    if (j < (size_t)op->length)
+      _fmpz_get_oz_limbs(r, op->coeffs + j, rop->limbs);
+    else
+      mpn_zero(r, rop->limbs);
+  }
+}
+
+void fmpz_mod_poly_oz_arena_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_arena_t op, const size_t i) {
+  assert(i < op->len);
+  const size_t n = op->n;
+  fmpz_mod_poly_fit_length(rop, n);
+
+#pragma omp parallel for if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  for(size_t j=0; j<n; j++)
+    _fmpz_set_oz_limbs(rop->coeffs + j, fmpz_mod_poly_oz_arena_slot(op, i, j), op->limbs);
+
+  _fmpz_mod_poly_set_length(rop, n);
+  _fmpz_mod_poly_normalise(rop);
+}
+
+void fmpz_mod_poly_oz_arena_set(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f) {
+  assert(h < op->len && f < op->len);
+  if (h == f)
+    return;
+  memcpy(fmpz_mod_poly_oz_arena_slot(op, h, 0), fmpz_mod_poly_oz_arena_slot(op, f, 0),
+         op->n * op->limbs * sizeof(mp_limb_t));
+}
+
+void fmpz_mod_poly_oz_arena_add(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f, const size_t g) {
+  assert(h < op->len && f < op->len && g < op->len);
+  const size_t n = op->n;
+  const size_t limbs = op->limbs;
+
+#pragma omp parallel for if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  for(size_t j=0; j<n; j++) {
+    mp_ptr r = fmpz_mod_poly_oz_arena_slot(op, h, j);
+    const mp_limb_t carry = mpn_add_n(r, fmpz_mod_poly_oz_arena_slot(op, f, j),
+                                      fmpz_mod_poly_oz_arena_slot(op, g, j), limbs);
+    if (carry || mpn_cmp(r, op->q, limbs) >= 0)
+      mpn_sub_n(r, r, op->q, limbs);
+  }
+}
+
+void fmpz_mod_poly_oz_arena_sub(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f, const size_t g) {
+  assert(h < op->len && f < op->len && g < op->len);
+  const size_t n = op->n;
+  const size_t limbs = op->limbs;
+
+#pragma omp parallel for if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  for(size_t j=0; j<n; j++) {
+    mp_ptr r = fmpz_mod_poly_oz_arena_slot(op, h, j);
+    const mp_limb_t borrow = mpn_sub_n(r, fmpz_mod_poly_oz_arena_slot(op, f, j),
+                                       fmpz_mod_poly_oz_arena_slot(op, g, j), limbs);
+    if (borrow)
+      mpn_add_n(r, r, op->q, limbs);
+  }
+}
+
+void fmpz_mod_poly_oz_arena_mul(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f, const size_t g) {
+  assert(h < op->len && f < op->len && g < op->len);
+  const size_t n = op->n;
+  const size_t limbs = op->limbs;
+
+#pragma omp parallel if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  {
+    mp_limb_t t[2*limbs];
+    mp_limb_t quo[limbs+1];
+
+#pragma omp for schedule(static)
+    for(size_t j=0; j<n; j++) {
+      mpn_mul_n(t, fmpz_mod_poly_oz_arena_slot(op, f, j), fmpz_mod_poly_oz_arena_slot(op, g, j), limbs);
+      /* the product is in t, hence h may be aliased with f or g */
+      mpn_tdiv_qr(quo, fmpz_mod_poly_oz_arena_slot(op, h, j), 0, t, 2*limbs, op->q, limbs);
+    }
+  }
+}
+
+int fmpz_mod_poly_oz_arena_is_zero(const fmpz_mod_poly_oz_arena_t op, const size_t i) {
+  assert(i < op->len);
+  mp_srcptr r = fmpz_mod_poly_oz_arena_slot(op, i, 0);
+  for(size_t l=0; l<op->n * op->limbs; l++) {
+    if (r[l])
+      return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,115 @@
+/**
+   @file arena.h
+   @brief Arrays of elements in the NTT domain stored in one contiguous limb array.
+
+   An `fmpz_mod_poly_t` stores its own copy of $q$ and an array of separately allocated `fmpz`
+   coefficients, each of which is heap allocated once it exceeds $62$ bits. For many elements
+   modulo the same $q$ this fragments the heap and wastes memory on allocator and pointer overhead.
+   An arena instead stores all slots of `len` elements in a single array of limbs with a fixed
+   stride of $\\lceil \\log_2 q / 64 \\rceil$ limbs per slot, i.e. slot $j$ of element $i$ is
+   stored at limb offset $(i·n + j)·\\mbox{limbs}$.
+*/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <flint/fmpz.h>
+#include <flint/fmpz_mod_poly.h>
+#include <oz/flags.h>
+
+/**
+   @brief Elements in the NTT domain modulo $q$ stored in one contiguous limb array.
+*/
+
+struct fmpz_mod_poly_oz_arena_struct {
+  size_t len;         //!< number of elements
+  size_t n;           //!< number of slots per element
+  size_t limbs;       //!< number of limbs per slot
+  mp_ptr q;           //!< modulus $q$ as `limbs` limbs
+  mp_ptr data;        //!< `len·n·limbs` limbs
+  size_t size;        //!< number of bytes allocated or mapped
+  size_t offset;      //!< offset of `data` in the allocation or mapping
+  int mapped;         //!< `data` was obtained via `mmap`
+};
+
+/**
+   @brief Elements in the NTT domain modulo $q$ stored in one contiguous limb array.
+*/
+
+typedef struct fmpz_mod_poly_oz_arena_struct fmpz_mod_poly_oz_arena_t[1];
+
+/**
+   @brief Initialise `len` elements with `n` slots each modulo $q$ to zero.
+
+   @param op            uninitialised arena
+   @param len           number of elements
+   @param n             number of slots per element
+   @param q             modulus $q > 1$
+   @param flags         if `OZ_HUGEPAGES` is set, storage is allocated with `mmap` and
+                        transparent huge pages are requested via `madvise`
+*/
+
+void fmpz_mod_poly_oz_arena_init(fmpz_mod_poly_oz_arena_t op, const size_t len, const size_t n, const fmpz_t q,
+                                 const oz_flag_t flags);
+
+/**
+   @brief Clear arena.
+*/
+
+void fmpz_mod_poly_oz_arena_clear(fmpz_mod_poly_oz_arena_t op);
+
+/**
+   @brief Return pointer to slot $j$ of element $i$.
+*/
+
+static inline mp_ptr fmpz_mod_poly_oz_arena_slot(const fmpz_mod_poly_oz_arena_t op, const size_t i, const size_t j) {
+  return op->data + (i*op->n + j)*op->limbs;
+}
+
+/**
+   @brief Set element $i$ of `rop` to `op`, which must be reduced modulo $q$.
+*/
+
+void fmpz_mod_poly_oz_arena_set_fmpz_mod_poly(fmpz_mod_poly_oz_arena_t rop, const size_t i, const fmpz_mod_poly_t op);
+
+/**
+   @brief Set `rop` to element $i$ of `op`.
+*/
+
+void fmpz_mod_poly_oz_arena_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_arena_t op, const size_t i);
+
+/**
+   @brief Set element $h$ to element $f$ of `op`.
+*/
+
+void fmpz_mod_poly_oz_arena_set(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f);
+
+/**
+   @brief Set element $h$ to the sum of elements $f$ and $g$ of `op`.
+*/
+
+void fmpz_mod_poly_oz_arena_add(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f, const size_t g);
+
+/**
+   @brief Set element $h$ to the difference of elements $f$ and $g$ of `op`.
+*/
+
+void fmpz_mod_poly_oz_arena_sub(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f, const size_t g);
+
+/**
+   @brief Set element $h$ to the product of elements $f$ and $g$ of `op`.
+
+   Any of $h$, $f$ and $g$ may be equal.
+*/
+
+void fmpz_mod_poly_oz_arena_mul(fmpz_mod_poly_oz_arena_t op, const size_t h, const size_t f, const size_t g);
+
+/**
+   @brief Return 1 if element $i$ is zero.
+*/
+
+int fmpz_mod_poly_oz_arena_is_zero(const fmpz_mod_poly_oz_arena_t op, const size_t i);
+
+#endif /* _ARENA_H_ */
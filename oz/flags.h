@@ -12,6 +12,7 @@
 
 typedef enum {
   OZ_VERBOSE    = 0x1, //!< print debug messages
+  OZ_HUGEPAGES  = 0x2, //!< back large allocations by transparent huge pages where supported
 } oz_flag_t;
 
 #endif /* _FLAGS_H */
@@ -5,15 +5,6 @@
 #include "oz.h"
 #include "flint-addons.h"
 
-static void _nmod_vec_oz_set_powers(mp_ptr op, const size_t n, const mp_limb_t w, const nmod_t q) {
-  mp_limb_t acc = 1;
-  op[0] = 1;
-  for(size_t i=1; i<n; i++) {
-    acc = n_mulmod2_preinv(acc, w, q.n, q.ninv);
-    op[i] = acc;
-  }
-}
-
 static const unsigned char bit_reverse_table_256[] =  {
   0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
   0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
@@ -34,67 +25,160 @@ static const unsigned char bit_reverse_table_256[] =  {
 };
 
 
-static void _nmod_vec_oz_ntt(mp_ptr rop, const mp_ptr op, const mp_ptr w, const size_t n, const nmod_t q) {
+static inline size_t _oz_bitrev24(const size_t i, const size_t k) {
+  unsigned int r;
+  r = (bit_reverse_table_256[i & 0xff] << 16) | \
+    (bit_reverse_table_256[(i >>  8) & 0xff] << 8) | \
+    (bit_reverse_table_256[(i >> 16) & 0xff]);
+  return (k) ? (r >> (24 - k)) : 0;
+}
+
+#ifdef __GNUC__
+#define OZ_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define OZ_ALWAYS_INLINE inline
+#endif
+
+void _nmod_vec_oz_set_powers_shoup(mp_ptr w, mp_ptr w_pre, const size_t n, const mp_limb_t phi, const nmod_t q) {
   const size_t k = n_flog(n,2);
+  assert(k <= 24);
+  mp_limb_t acc = 1;
+  for(size_t i=0; i<n; i++) {
+    const size_t r = _oz_bitrev24(i, k);
+    w[r] = acc;
+    mp_limb_t rem;
+    udiv_qrnnd(w_pre[r], rem, acc, 0, q.n);
+    (void)rem;
+    acc = n_mulmod2_preinv(acc, phi, q.n, q.ninv);
+  }
+}
+
+/**
+   Butterflies for blocks i_begin ≤ i < i_end of the stage with m blocks of span 2t.
+*/
+
+static OZ_ALWAYS_INLINE void _nmod_vec_oz_ntt_stage(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t m, const size_t t,
+                                                    const size_t i_begin, const size_t i_end, const mp_limb_t p) {
+  const mp_limb_t p2 = 2*p;
+  for(size_t i=i_begin; i<i_end; i++) {
+    const mp_limb_t W = w[m+i];
+    const mp_limb_t W_pre = w_pre[m+i];
+    mp_ptr a0 = a + 2*i*t;
+    mp_ptr a1 = a0 + t;
+    for(size_t j=0; j<t; j++) {
+      mp_limb_t X = a0[j];
+      X -= (X >= p2) ? p2 : 0;
+      mp_limb_t Q, lo;
+      umul_ppmm(Q, lo, W_pre, a1[j]);
+      (void)lo;
+      const mp_limb_t T = W*a1[j] - Q*p;
+      a0[j] = X + T;
+      a1[j] = X - T + p2;
+    }
+  }
+}
+
+/**
+   In-place negacyclic Cooley-Tukey NTT with twist by powers of φ merged into the twiddles, Shoup
+   multiplication and Harvey's lazy reduction, i.e. all values are kept in [0,4p) and only reduced to
+   [0,p) at the end. On output a[i] = a(φ^(2rev(i)+1)). Requires p < 2^62.
 
-  mp_ptr a = _nmod_vec_init(n);
+   Stages are processed breadth-first until a sub-transform spans at most `OZ_NMOD_NTT_BLOCK` limbs,
+   then each such sub-transform is finished depth-first while it is in cache.
 
-#if 0
-  for (size_t i = 0; i < n; i++) {
-    size_t ii = i, r=0;
-    for (size_t h = 0; h < k; h++) {
-      r = (r << 1) | (ii & 1);
-      ii >>= 1;
+   This is always inlined so that callers passing a constant n get all loop bounds and strides as
+   compile-time constants.
+*/
+
+static OZ_ALWAYS_INLINE void _nmod_vec_oz_ntt_kernel(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q) {
+  const mp_limb_t p = q.n;
+  const mp_limb_t p2 = 2*p;
+  assert(p < (UWORD(1)<<(FLINT_BITS-2)));
+
+  size_t m = 1, t = n/2;
+  for(; m<n && 2*t > OZ_NMOD_NTT_BLOCK; m*=2, t/=2)
+    _nmod_vec_oz_ntt_stage(a, w, w_pre, m, t, 0, m, p);
+
+  if (m<n) {
+    const size_t span = 2*t;
+    for(size_t off=0; off<n; off+=span) {
+      for(size_t mm=m, tt=t; mm<n; mm*=2, tt/=2)
+        _nmod_vec_oz_ntt_stage(a, w, w_pre, mm, tt, off/(2*tt), (off+span)/(2*tt), p);
     }
-    a[r] = op[i];
   }
-#else
-  assert(k <= 24);
-  assert(sizeof(int) >= 4);
-  for (unsigned int i = 0; i < n; i++) {
-    unsigned int r;
-    r = (bit_reverse_table_256[i & 0xff] << 16) | \
-      (bit_reverse_table_256[(i >>  8) & 0xff] << 8) | \
-      (bit_reverse_table_256[(i >> 16) & 0xff]);
-    r >>= (24 - k);
-    a[r] = op[i];
+
+  for(size_t i=0; i<n; i++) {
+    mp_limb_t x = a[i];
+    x -= (x >= p2) ? p2 : 0;
+    x -= (x >= p)  ? p  : 0;
+    a[i] = x;
   }
-#endif
+}
+
+void _nmod_vec_oz_ntt_generic(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q) {
+  _nmod_vec_oz_ntt_kernel(a, w, w_pre, n, q);
+}
 
-  mp_ptr b = _nmod_vec_init(n);
+/**
+   Kernels for n = 2^K with n fixed at compile time.
+*/
 
-  const double ninv = n_precompute_inverse(q.n);
-  for(size_t i=0; i<k; i++) {
-    const mp_limb_t tkm = ~(((1UL)<<(k-1-i)) - 1);
-    for(size_t j=0; j<n/2; j++) {
-      const size_t pij = j & tkm;
-      mp_limb_t tmp = n_mulmod_precomp(a[2*j+1], w[pij], q.n, ninv);
-      b[j]      = n_addmod(a[2*j], tmp, q.n);
-      b[j+n/2]  = n_submod(a[2*j], tmp, q.n);
-    }
-    if(i!=k-1)
-      _nmod_vec_set(a, b, n);
+#define OZ_NMOD_NTT_SPECIALISE(K)                                                                    \
+  static void _nmod_vec_oz_ntt_##K(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q) { \
+    assert(n == ((size_t)1)<<(K));                                                                   \
+    (void)n;                                                                                         \
+    _nmod_vec_oz_ntt_kernel(a, w, w_pre, ((size_t)1)<<(K), q);                                       \
   }
-  _nmod_vec_set(rop, b, n);
-  _nmod_vec_clear(b);
-  _nmod_vec_clear(a);
+
+OZ_NMOD_NTT_SPECIALISE(11)
+OZ_NMOD_NTT_SPECIALISE(12)
+OZ_NMOD_NTT_SPECIALISE(13)
+OZ_NMOD_NTT_SPECIALISE(14)
+OZ_NMOD_NTT_SPECIALISE(15)
+OZ_NMOD_NTT_SPECIALISE(16)
+
+#undef OZ_NMOD_NTT_SPECIALISE
+
+static const _nmod_vec_oz_ntt_func _nmod_vec_oz_ntt_specialised[OZ_NMOD_NTT_MAX_LOG + 1] = {
+  [11] = _nmod_vec_oz_ntt_11,
+  [12] = _nmod_vec_oz_ntt_12,
+  [13] = _nmod_vec_oz_ntt_13,
+  [14] = _nmod_vec_oz_ntt_14,
+  [15] = _nmod_vec_oz_ntt_15,
+  [16] = _nmod_vec_oz_ntt_16,
+};
+
+_nmod_vec_oz_ntt_func _nmod_vec_oz_ntt_get_kernel(const size_t n) {
+  const size_t k = n_flog(n, 2);
+  if (k <= OZ_NMOD_NTT_MAX_LOG && _nmod_vec_oz_ntt_specialised[k])
+    return _nmod_vec_oz_ntt_specialised[k];
+  return _nmod_vec_oz_ntt_generic;
+}
+
+void _nmod_vec_oz_ntt(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q) {
+  _nmod_vec_oz_ntt_get_kernel(n)(a, w, w_pre, n, q);
 }
 
 
-static mp_limb_t _nmod_vec_oz_resultant(const mp_ptr a, const long n, nmod_t q) {
-  const mp_limb_t w_ = _nmod_nth_root(2*n, q.n);
-  mp_ptr w = _nmod_vec_init(2*n);
-  mp_ptr t = _nmod_vec_init(2*n);
+/**
+   Return res(a, x^n+1) mod p, `a` is overwritten.
+*/
 
-  _nmod_vec_oz_set_powers(w, 2*n, w_, q);
-  _nmod_vec_oz_ntt(t, a, w, 2*n, q);
+static mp_limb_t _nmod_vec_oz_resultant(mp_ptr a, const long n, nmod_t q) {
+  const mp_limb_t phi = _nmod_nth_root(2*n, q.n);
+  mp_ptr w = _nmod_vec_init(n);
+  mp_ptr w_pre = _nmod_vec_init(n);
 
+  _nmod_vec_oz_set_powers_shoup(w, w_pre, n, phi, q);
+  _nmod_vec_oz_ntt(a, w, w_pre, n, q);
+
+  /* res(a, x^n+1) = ∏ a(φ^(2i+1)) */
   mp_limb_t acc = 1;
-  for(int i=1; i<2*n; i+=2)
-    acc = n_mulmod2_preinv(acc, t[i], q.n, q.ninv);
+  for(long i=0; i<n; i++)
+    acc = n_mulmod2_preinv(acc, a[i], q.n, q.ninv);
 
+  _nmod_vec_clear(w_pre);
   _nmod_vec_clear(w);
-  _nmod_vec_clear(t);
   return acc;
 }
 
@@ -102,9 +186,10 @@ static mp_limb_t _nmod_vec_oz_resultant(const mp_ptr a, const long n, nmod_t q)
 mp_limb_t nmod_poly_oz_resultant(const nmod_poly_t a, const long n) {
   nmod_t q;
   nmod_init(&q, nmod_poly_modulus(a));
-  mp_ptr t = _nmod_vec_init(2*n);
+  assert(a->length <= n);
+  mp_ptr t = _nmod_vec_init(n);
   _nmod_vec_set(t, a->coeffs, a->length);
-  for(long i=a->length; i<2*n; i++)
+  for(long i=a->length; i<n; i++)
     t[i] = 0;
   mp_limb_t res = _nmod_vec_oz_resultant(t, n, q);
   _nmod_vec_clear(t);
@@ -133,7 +218,7 @@ void _fmpz_poly_oz_ideal_norm(fmpz_t norm, const fmpz_poly_t f, const long n) {
   fmpz_set(l, f->coeffs + n-1);
 
   /* set size of first prime */
-  pbits = FLINT_D_BITS - 1;
+  pbits = FLINT_BITS - 3; /* _nmod_vec_oz_ntt requires p < 2^62 */
 
   num_primes = (bound + pbits - 1)/pbits;
   mp_ptr parr = _nmod_vec_init(num_primes);
@@ -147,8 +232,8 @@ void _fmpz_poly_oz_ideal_norm(fmpz_t norm, const fmpz_poly_t f, const long n) {
   mp_ptr a[num_threads];
 
   for(i=0; i<num_threads; i++) {
-    a[i] = _nmod_vec_init(2*n);
-    for(long j=0; j<2*n; j++)
+    a[i] = _nmod_vec_init(n);
+    for(long j=0; j<n; j++)
       a[i][j] = 0;
   }
 
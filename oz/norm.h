@@ -7,6 +7,15 @@
 #include <flint/fmpz_poly.h>
 #include <flint/fmpq_poly.h>
 
+/**
+   Sub-transforms spanning at most this many limbs are computed depth-first by the resultant NTT,
+   i.e. while they are in L1.
+*/
+
+#ifndef OZ_NMOD_NTT_BLOCK
+#define OZ_NMOD_NTT_BLOCK 2048
+#endif
+
 static inline mp_limb_t _n_next_oz_good_probaprime(mp_limb_t p, const mp_limb_t n) {
   p += n;
   while (!n_is_probabprime(p)) {
@@ -34,6 +43,45 @@ static inline mp_limb_t _nmod_nth_root(const long n, mp_limb_t p) {
   return a;
 }
 
+/**
+   Ring dimensions $2^{11} ≤ n ≤ 2^{16}$ have word-sized NTT kernels specialised at compile time.
+*/
+
+#define OZ_NMOD_NTT_MIN_LOG 11
+#define OZ_NMOD_NTT_MAX_LOG 16
+
+/**
+   @brief In-place negacyclic NTT of length $n$ modulo a word-sized prime $p < 2^{62}$.
+*/
+
+typedef void (*_nmod_vec_oz_ntt_func)(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q);
+
+/**
+   @brief Set $w_i = φ^{\\mbox{rev}(i)}$ and $w'_i = \\lfloor w_i·2^{64}/p \\rfloor$ for $0 ≤ i < n$.
+*/
+
+void _nmod_vec_oz_set_powers_shoup(mp_ptr w, mp_ptr w_pre, const size_t n, const mp_limb_t phi, const nmod_t q);
+
+/**
+   @brief Compute $a_i = a(φ^{2\\mbox{rev}(i)+1})$ in place given twiddles from `_nmod_vec_oz_set_powers_shoup`.
+
+   Dispatches to a kernel specialised for $n$ if one exists.
+*/
+
+void _nmod_vec_oz_ntt(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q);
+
+/**
+   @brief Same as `_nmod_vec_oz_ntt` but never uses a specialised kernel.
+*/
+
+void _nmod_vec_oz_ntt_generic(mp_ptr a, mp_srcptr w, mp_srcptr w_pre, const size_t n, const nmod_t q);
+
+/**
+   @brief Return the kernel `_nmod_vec_oz_ntt` dispatches to for dimension $n$.
+*/
+
+_nmod_vec_oz_ntt_func _nmod_vec_oz_ntt_get_kernel(const size_t n);
+
 void nmod_poly_oz_set_powers(nmod_poly_t op, const size_t n, const mp_limb_t w);
 void _nmod_poly_oz_ntt(nmod_poly_t rop, const nmod_poly_t op, const nmod_poly_t w, const size_t n);
 mp_limb_t nmod_poly_oz_resultant(const nmod_poly_t a, const long n);
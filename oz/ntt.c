@@ -1,4 +1,7 @@
 #include <assert.h>
+#include <omp.h>
+#include <sched.h>
+#include <string.h>
 #include "ntt.h"
 #include "util.h"
 
@@ -48,95 +51,257 @@ static int _fmpz_nth_root(fmpz_t rop, const long n, const fmpz_t q) {
 }
 
 static void fmpz_mod_poly_oz_set_powers(fmpz_mod_poly_t op, const size_t n, const fmpz_t w) {
-  fmpz_mod_poly_realloc(op, n);
-
-  fmpz_t acc; fmpz_init_set_ui(acc, 1);
-  fmpz_set(op->coeffs + 0, acc);
-  for(size_t i=1; i<n; i++) {
-    fmpz_mul(acc, acc, w);
-    fmpz_mod(acc, acc, fmpz_mod_poly_modulus(op));
-    fmpz_set(op->coeffs+i, acc);
+  const fmpz *q = fmpz_mod_poly_modulus(op);
+  fmpz_mod_poly_fit_length(op, n);
+
+  /* each thread starts its chunk at w^start */
+#pragma omp parallel if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  {
+    const size_t nt = omp_get_num_threads();
+    const size_t id = omp_get_thread_num();
+    const size_t start = (n*id)/nt;
+    const size_t end = (n*(id+1))/nt;
+
+    if (start < end) {
+      fmpz_t acc; fmpz_init(acc);
+      fmpz_powm_ui(acc, w, start, q);
+      fmpz_set(op->coeffs + start, acc);
+      for(size_t i=start+1; i<end; i++) {
+        fmpz_mul(acc, acc, w);
+        fmpz_mod(acc, acc, q);
+        fmpz_set(op->coeffs+i, acc);
+      }
+      fmpz_clear(acc);
+    }
   }
   op->length = n;
   _fmpz_mod_poly_normalise(op);
-  fmpz_clear(acc);
 }
 
-void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w, const size_t n) {
-  if (n == 1) {
-    fmpz_mod_poly_set(rop, op);
+static inline void _fmpz_oz_mulmod_preinvn(fmpz_t rop, const fmpz_t a, const fmpz_t b, const fmpz_t q,
+                                           const fmpz_preinvn_t q_inv, fmpz_t tmp, fmpz_t quo) {
+  fmpz_mul(tmp, a, b);
+  fmpz_fdiv_qr_preinvn(quo, rop, tmp, q, q_inv);
+}
+
+static inline size_t _oz_bitrev(size_t i, const size_t k) {
+  size_t r = 0;
+  for (size_t h = 0; h < k; h++) {
+    r = (r << 1) | (i & 1);
+    i >>= 1;
+  }
+  return r;
+}
+
+static void fmpz_mod_poly_oz_ntt_set_input(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
+  const size_t len = FLINT_MIN((size_t)fmpz_mod_poly_length(op), n);
+  fmpz_mod_poly_fit_length(rop, n);
+  if (rop != op)
+    _fmpz_vec_set(rop->coeffs, op->coeffs, len);
+  _fmpz_vec_zero(rop->coeffs + len, n - len);
+  rop->length = n;
+}
+
+static inline void _fmpz_oz_ntt_butterfly(fmpz *a0, fmpz *a1, const fmpz *w, const int w_is_one, const fmpz_t q, fmpz_t tmp) {
+  if (w_is_one) {
+    fmpz_set(tmp, a1);
+  } else {
+    fmpz_mul(tmp, a1, w);
+    fmpz_mod(tmp, tmp, q);
+  }
+  fmpz_sub(a1, a0, tmp);
+  if (fmpz_sgn(a1) < 0)
+    fmpz_add(a1, a1, q);
+  fmpz_add(a0, a0, tmp);
+  if (fmpz_cmpabs(a0, q) >= 0)
+    fmpz_sub(a0, a0, q);
+}
+
+static void _fmpz_vec_oz_ntt_parallel(fmpz *a, const fmpz *w, const size_t n, const fmpz_t q) {
+  const size_t k = n_flog(n,2);
+
+#pragma omp parallel
+  {
+    fmpz_t tmp; fmpz_init(tmp);
+
+    for(size_t m=1, t=n/2; m<n; m*=2, t/=2) {
+      /* butterflies within a stage are independent, the implicit barrier separates stages */
+#pragma omp for schedule(static)
+      for(size_t b=0; b<n/2; b++) {
+        const size_t i = b/t;
+        const size_t j = b%t;
+        fmpz *a0 = a + 2*i*t + j;
+        _fmpz_oz_ntt_butterfly(a0, a0 + t, w + _oz_bitrev(i, k-1), i == 0, q, tmp);
+      }
+    }
+
+    /* pairs (i, rev(i)) are disjoint */
+#pragma omp for schedule(static)
+    for(size_t i=0; i<n; i++) {
+      const size_t j = _oz_bitrev(i, k);
+      if (i<j)
+        fmpz_swap(a + i, a + j);
+    }
+
+    fmpz_clear(tmp);
+  }
+}
+
+void _fmpz_vec_oz_ntt(fmpz *a, const fmpz *w, const size_t n, const fmpz_t q, fmpz_t tmp) {
+  if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel() && omp_get_max_threads() > 1) {
+    _fmpz_vec_oz_ntt_parallel(a, w, n, q);
     return;
   }
-  const fmpz *q = fmpz_mod_poly_modulus(op);
   const size_t k = n_flog(n,2);
 
-  fmpz_mod_poly_t a; fmpz_mod_poly_init2(a, q, n);
-  for (size_t i = 0; i < n; i++) {
-    size_t ii = i, r=0;
-    for (size_t h = 0; h < k; h++) {
-      r = (r << 1) | (ii & 1);
-      ii >>= 1;
+  /* Cooley-Tukey, natural order in, bit-reversed order out, block i uses ω^rev(i) */
+  for(size_t m=1, t=n/2; m<n; m*=2, t/=2) {
+    for(size_t i=0; i<m; i++) {
+      const fmpz *w_i = w + _oz_bitrev(i, k-1);
+      fmpz *a0 = a + 2*i*t;
+      for(size_t j=0; j<t; j++)
+        _fmpz_oz_ntt_butterfly(a0 + j, a0 + t + j, w_i, i == 0, q, tmp);
     }
-    fmpz_set(a->coeffs+r, op->coeffs+i);
   }
-  fmpz_mod_poly_t b; fmpz_mod_poly_init2(b, q, n);
 
-  fmpz *a_hdl = a->coeffs;
-  fmpz *b_hdl = b->coeffs;
+  /* undo bit-reversal in place, swapping fmpz is free */
+  for(size_t i=0, j=0; i<n; i++) {
+    if (i<j)
+      fmpz_swap(a + i, a + j);
+    size_t bit = n>>1;
+    while (j & bit) {
+      j ^= bit;
+      bit >>= 1;
+    }
+    j |= bit;
+  }
+}
 
-  for(size_t i=0; i<k; i++) {
-/* #pragma omp parallel for */
-    for(size_t j=0; j<n/2; j++) {
-      fmpz_t tmp;  fmpz_init(tmp);
-      const size_t tk  = (1UL<<(k-1-i));
-      const size_t pij = (j/tk) * tk;
-      fmpz_mul(tmp, a_hdl + 2*j+1, w->coeffs + pij);
-      if(pij)
-        fmpz_mod(tmp, tmp, q);
-      fmpz_add(b_hdl + j,       a_hdl + 2*j, tmp);
-      if (fmpz_cmpabs(b_hdl + j, q) >= 0)
-        fmpz_sub(b_hdl + j, b_hdl + j, q);
-      fmpz_sub(b_hdl + j + n/2, a_hdl + 2*j, tmp);
-      if (fmpz_sgn(b_hdl + j + n/2) < 0)
-        fmpz_add(b_hdl + j + n/2, b_hdl + j + n/2, q);
-      fmpz_clear(tmp);
+static inline void _fmpz_oz_ntt_nwc_butterfly(fmpz *a0, fmpz *a1, const fmpz *s, const fmpz_t q, const fmpz_preinvn_t q_inv,
+                                              fmpz_t tmp, fmpz_t quo) {
+  _fmpz_oz_mulmod_preinvn(tmp, a1, s, q, q_inv, tmp, quo);
+  fmpz_sub(a1, a0, tmp);
+  if (fmpz_sgn(a1) < 0)
+    fmpz_add(a1, a1, q);
+  fmpz_add(a0, a0, tmp);
+  if (fmpz_cmpabs(a0, q) >= 0)
+    fmpz_sub(a0, a0, q);
+}
+
+static inline void _fmpz_oz_intt_nwc_butterfly(fmpz *a0, fmpz *a1, const fmpz *s, const fmpz *n_inv, const fmpz_t q,
+                                               const fmpz_preinvn_t q_inv, fmpz_t tmp, fmpz_t quo) {
+  fmpz_sub(tmp, a0, a1);
+  fmpz_add(a0, a0, a1);
+  if (fmpz_cmpabs(a0, q) >= 0)
+    fmpz_sub(a0, a0, q);
+  if (n_inv)
+    _fmpz_oz_mulmod_preinvn(a0, a0, n_inv, q, q_inv, a1, quo);
+  _fmpz_oz_mulmod_preinvn(a1, tmp, s, q, q_inv, tmp, quo);
+}
+
+void _fmpz_vec_oz_ntt_nwc(fmpz *a, const fmpz_mod_poly_oz_ntt_precomp_t precomp, fmpz_t tmp, fmpz_t quo) {
+  const size_t n = precomp->n;
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->psi_br);
+  const fmpz *psi_br = precomp->psi_br->coeffs;
+
+  if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel() && omp_get_max_threads() > 1) {
+#pragma omp parallel
+    {
+      fmpz_t tmp_; fmpz_init(tmp_);
+      fmpz_t quo_; fmpz_init(quo_);
+      for(size_t m=1, t=n/2; m<n; m*=2, t/=2) {
+#pragma omp for schedule(static)
+        for(size_t b=0; b<n/2; b++) {
+          const size_t i = b/t;
+          fmpz *a0 = a + 2*i*t + b%t;
+          _fmpz_oz_ntt_nwc_butterfly(a0, a0 + t, psi_br + m + i, q, precomp->q_inv, tmp_, quo_);
+        }
+      }
+      fmpz_clear(quo_);
+      fmpz_clear(tmp_);
     }
-    if(i!=k-1) {
-      fmpz *t = a_hdl;
-      a_hdl = b_hdl;
-      b_hdl = t;
+    return;
+  }
+
+  /* Cooley-Tukey with merged powers of φ, natural order in, bit-reversed order out */
+  for(size_t m=1, t=n/2; m<n; m*=2, t/=2) {
+    for(size_t i=0; i<m; i++) {
+      fmpz *a0 = a + 2*i*t;
+      for(size_t j=0; j<t; j++)
+        _fmpz_oz_ntt_nwc_butterfly(a0 + j, a0 + t + j, psi_br + m + i, q, precomp->q_inv, tmp, quo);
     }
   }
-  fmpz_mod_poly_realloc(rop, n);
-  _fmpz_vec_set(rop->coeffs, b_hdl, n);
-  rop->length = n;
-  fmpz_mod_poly_clear(b);
-  fmpz_mod_poly_clear(a);
 }
 
-void fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
-  const fmpz *q = fmpz_mod_poly_modulus(op);
-  fmpz_t w;  fmpz_init(w);
-  if (!_fmpz_nth_root(w, n, q)) {
-    fmpz_clear(w);
-    oz_die("q does not have a n-th root of unity");
+void _fmpz_vec_oz_intt_nwc(fmpz *a, const fmpz_mod_poly_oz_ntt_precomp_t precomp, fmpz_t tmp, fmpz_t quo) {
+  const size_t n = precomp->n;
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->psi_inv_br);
+  const fmpz *psi_inv_br = precomp->psi_inv_br->coeffs;
+
+  if (n == 1) {
+    _fmpz_oz_mulmod_preinvn(a, a, precomp->n_inv, q, precomp->q_inv, tmp, quo);
+    return;
   }
-  fmpz_mod_poly_t wvec; fmpz_mod_poly_init2(wvec, q, n);
-  fmpz_mod_poly_oz_set_powers(wvec, n, w);
-  fmpz_clear(w);
 
-  _fmpz_mod_poly_oz_ntt(rop, op, wvec, n);
-  fmpz_mod_poly_clear(wvec);
+  if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel() && omp_get_max_threads() > 1) {
+#pragma omp parallel
+    {
+      fmpz_t tmp_; fmpz_init(tmp_);
+      fmpz_t quo_; fmpz_init(quo_);
+      for(size_t m=n/2, t=1; m>=1; m/=2, t*=2) {
+        const fmpz *n_inv = (m == 1) ? precomp->n_inv : NULL;
+#pragma omp for schedule(static)
+        for(size_t b=0; b<n/2; b++) {
+          const size_t i = b/t;
+          fmpz *a0 = a + 2*i*t + b%t;
+          _fmpz_oz_intt_nwc_butterfly(a0, a0 + t, psi_inv_br + m + i, n_inv, q, precomp->q_inv, tmp_, quo_);
+        }
+      }
+      fmpz_clear(quo_);
+      fmpz_clear(tmp_);
+    }
+    return;
+  }
+
+  /* Gentleman-Sande with merged powers of φ^{-1}, bit-reversed order in, natural order out, 1/n is
+     folded into the last stage */
+  for(size_t m=n/2, t=1; m>=1; m/=2, t*=2) {
+    const fmpz *n_inv = (m == 1) ? precomp->n_inv : NULL;
+    for(size_t i=0; i<m; i++) {
+      fmpz *a0 = a + 2*i*t;
+      for(size_t j=0; j<t; j++)
+        _fmpz_oz_intt_nwc_butterfly(a0 + j, a0 + t + j, psi_inv_br + m + i, n_inv, q, precomp->q_inv, tmp, quo);
+    }
+  }
 }
 
-void fmpz_mod_poly_oz_intt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
+void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w, const size_t n) {
+  const fmpz *q = fmpz_mod_poly_modulus(op);
+  fmpz_mod_poly_oz_ntt_set_input(rop, op, n);
+
+  fmpz_t tmp; fmpz_init(tmp);
+  _fmpz_vec_oz_ntt(rop->coeffs, w->coeffs, n, q, tmp);
+  fmpz_clear(tmp);
+}
+
+static int _fmpz_mod_poly_oz_ntt_has_precomp(const size_t n, const fmpz_t q) {
+  fmpz_t qm1;
+  fmpz_init_set(qm1, q);
+  fmpz_sub_ui(qm1, qm1, 1);
+  const int r = fmpz_divisible_si(qm1, 2*n);
+  fmpz_clear(qm1);
+  return r;
+}
+
+static void _fmpz_mod_poly_oz_ntt_nocache(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n, const int inverse) {
   const fmpz *q = fmpz_mod_poly_modulus(op);
   fmpz_t w;  fmpz_init(w);
   if (!_fmpz_nth_root(w, n, q)) {
     fmpz_clear(w);
     oz_die("q does not have a n-th root of unity");
   }
-  fmpz_invmod(w, w, fmpz_mod_poly_modulus(op));
+  if (inverse)
+    fmpz_invmod(w, w, q);
   fmpz_mod_poly_t wvec; fmpz_mod_poly_init2(wvec, q, n);
   fmpz_mod_poly_oz_set_powers(wvec, n, w);
   fmpz_clear(w);
@@ -145,21 +310,47 @@ void fmpz_mod_poly_oz_intt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const
   fmpz_mod_poly_clear(wvec);
 }
 
-
-void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q) {
-  fmpz_t w;  fmpz_init(w);
-  if (!_fmpz_nth_root(w, n, q)) {
-    fmpz_clear(w);
-    oz_die("q does not have a n-th root of unity");
+void fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
+  const fmpz *q = fmpz_mod_poly_modulus(op);
+  if (!_fmpz_mod_poly_oz_ntt_has_precomp(n, q)) {
+    _fmpz_mod_poly_oz_ntt_nocache(rop, op, n, 0);
+    return;
   }
+  fmpz_mod_poly_oz_ntt_precomp_struct *precomp = fmpz_mod_poly_oz_ntt_precomp_ref(n, q);
+  _fmpz_mod_poly_oz_ntt(rop, op, precomp->w, n);
+  fmpz_mod_poly_oz_ntt_precomp_unref(precomp);
+}
 
-  fmpz_t phi;  fmpz_init(phi);
-  if(!fmpz_sqrtmod(phi, w, q)) {
-    fmpz_clear(phi);
-    oz_die("q does not have a 2n-th root of unity");
+void fmpz_mod_poly_oz_intt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
+  const fmpz *q = fmpz_mod_poly_modulus(op);
+  if (!_fmpz_mod_poly_oz_ntt_has_precomp(n, q)) {
+    _fmpz_mod_poly_oz_ntt_nocache(rop, op, n, 1);
+    return;
   }
+  fmpz_mod_poly_oz_ntt_precomp_struct *precomp = fmpz_mod_poly_oz_ntt_precomp_ref(n, q);
+  _fmpz_mod_poly_oz_ntt(rop, op, precomp->w_inv, n);
+  fmpz_mod_poly_oz_ntt_precomp_unref(precomp);
+}
 
+
+static void fmpz_mod_poly_oz_set_powers_bitrev_n(fmpz_mod_poly_t op, const size_t n, const fmpz_t phi) {
+  const size_t k = n_flog(n,2);
+  fmpz_mod_poly_t tmp; fmpz_mod_poly_init2(tmp, fmpz_mod_poly_modulus(op), n);
+  fmpz_mod_poly_oz_set_powers(tmp, n, phi);
+  fmpz_mod_poly_fit_length(op, n);
+  for(size_t i=0; i<n; i++)
+    fmpz_swap(op->coeffs + i, tmp->coeffs + _oz_bitrev(i, k));
+  op->length = n;
+  fmpz_mod_poly_clear(tmp);
+}
+
+void _fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q, const fmpz_t phi_) {
   op->n = n;
+  fmpz_preinvn_init(op->q_inv, q);
+
+  fmpz_t w;  fmpz_init(w);
+  fmpz_mul(w, phi_, phi_);
+  fmpz_mod(w, w, q);
 
   fmpz_mod_poly_init2(op->w, q, n);
   fmpz_mod_poly_oz_set_powers(op->w, n, w);
@@ -169,30 +360,239 @@ void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const
   fmpz_mod_poly_oz_set_powers(op->w_inv, n, w);
   fmpz_clear(w);
 
-  fmpz_mod_poly_init2(op->phi, q, n);
-  fmpz_mod_poly_oz_set_powers(op->phi, n, phi);
+  fmpz_init(op->phi);
+  fmpz_mod(op->phi, phi_, q);
+
+  fmpz_t phi;  fmpz_init_set(phi, op->phi);
+  fmpz_mod_poly_init2(op->psi_br, q, n);
+  fmpz_mod_poly_oz_set_powers_bitrev_n(op->psi_br, n, phi);
 
   fmpz_invmod(phi, phi, q);
-  fmpz_mod_poly_init2(op->phi_inv, q, n);
-  fmpz_mod_poly_oz_set_powers(op->phi_inv, n, phi);
+  fmpz_mod_poly_init2(op->psi_inv_br, q, n);
+  fmpz_mod_poly_oz_set_powers_bitrev_n(op->psi_inv_br, n, phi);
   fmpz_clear(phi);
 
-  /** @note We fold 1/n into φ^-1 **/
-  fmpz_t n_inv;  fmpz_init_set_ui(n_inv, n);
-  fmpz_invmod(n_inv, n_inv, q);
+  /** @note We fold 1/n into the last stage of the inverse transform **/
+  fmpz_init_set_ui(op->n_inv, n);
+  fmpz_invmod(op->n_inv, op->n_inv, q);
 
-  for(size_t i=0; i<n; i++) {
-    fmpz_mul(op->phi_inv->coeffs+i, n_inv, op->phi_inv->coeffs+i);
-    fmpz_mod(op->phi_inv->coeffs+i, op->phi_inv->coeffs+i, q);
+  if (n > 1) {
+    fmpz_mul(op->psi_inv_br->coeffs + 1, op->psi_inv_br->coeffs + 1, op->n_inv);
+    fmpz_mod(op->psi_inv_br->coeffs + 1, op->psi_inv_br->coeffs + 1, q);
+  }
+
+  const size_t k = n_flog(n, 2);
+  op->br = (size_t*)malloc(n * sizeof(size_t));
+  for(size_t i=0; i<n; i++)
+    op->br[i] = _oz_bitrev(i, k);
+}
+
+/**
+   Set $φ$ to the primitive $2n$-th root of unity modulo $q$ used when no root is given.
+*/
+
+static void _fmpz_mod_poly_oz_ntt_root(fmpz_t phi, const size_t n, const fmpz_t q) {
+  fmpz_t w;  fmpz_init(w);
+  if (!_fmpz_nth_root(w, n, q)) {
+    fmpz_clear(w);
+    oz_die("q does not have a n-th root of unity");
+  }
+
+  if(!fmpz_sqrtmod(phi, w, q)) {
+    fmpz_clear(w);
+    oz_die("q does not have a 2n-th root of unity");
   }
-  fmpz_clear(n_inv);
+  fmpz_clear(w);
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q) {
+  fmpz_t phi;  fmpz_init(phi);
+  _fmpz_mod_poly_oz_ntt_root(phi, n, q);
+  _fmpz_mod_poly_oz_ntt_precomp_init(op, n, q, phi);
+  fmpz_clear(phi);
 }
 
 void fmpz_mod_poly_oz_ntt_precomp_clear(fmpz_mod_poly_oz_ntt_precomp_t op) {
   fmpz_mod_poly_clear(op->w);
   fmpz_mod_poly_clear(op->w_inv);
-  fmpz_mod_poly_clear(op->phi);
-  fmpz_mod_poly_clear(op->phi_inv);
+  fmpz_mod_poly_clear(op->psi_br);
+  fmpz_mod_poly_clear(op->psi_inv_br);
+  fmpz_clear(op->phi);
+  fmpz_clear(op->n_inv);
+  fmpz_preinvn_clear(op->q_inv);
+  free(op->br);
+}
+
+/**
+   Process-wide registry of pre-computed NTT data, a singly linked list as we expect only a handful of
+   entries. Entries are built outside of the critical section: a thread inserts a placeholder which
+   is marked ready once its tables are built, other threads requesting it wait for that. Entries
+   without references are kept for later requests, at most `OZ_NTT_PRECOMP_IDLE` of them, evicting
+   the least recently used.
+*/
+
+struct _fmpz_mod_poly_oz_ntt_precomp_entry {
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  size_t n;
+  fmpz_t q;
+  fmpz_t phi;                 //!< φ mod q
+  int canonical;              //!< φ is the root picked by `fmpz_mod_poly_oz_ntt_precomp_init`
+  int ready;                  //!< `precomp` is built
+  size_t refcount;
+  uint64_t last_use;
+  struct _fmpz_mod_poly_oz_ntt_precomp_entry *next;
+};
+
+static struct _fmpz_mod_poly_oz_ntt_precomp_entry *_fmpz_mod_poly_oz_ntt_precomp_registry = NULL;
+static uint64_t _fmpz_mod_poly_oz_ntt_precomp_clock = 0;
+
+static void _fmpz_mod_poly_oz_ntt_precomp_entry_free(struct _fmpz_mod_poly_oz_ntt_precomp_entry *e) {
+  fmpz_mod_poly_oz_ntt_precomp_clear(e->precomp);
+  fmpz_clear(e->q);
+  fmpz_clear(e->phi);
+  free(e);
+}
+
+/* call inside the critical section, returns evicted entries as a list to be freed outside of it */
+
+static struct _fmpz_mod_poly_oz_ntt_precomp_entry *_fmpz_mod_poly_oz_ntt_precomp_evict(const size_t keep) {
+  struct _fmpz_mod_poly_oz_ntt_precomp_entry *evicted = NULL;
+
+  while (1) {
+    size_t idle = 0;
+    struct _fmpz_mod_poly_oz_ntt_precomp_entry **oldest = NULL;
+    for(struct _fmpz_mod_poly_oz_ntt_precomp_entry **prev = &_fmpz_mod_poly_oz_ntt_precomp_registry; *prev; prev = &(*prev)->next) {
+      if ((*prev)->refcount)
+        continue;
+      idle++;
+      if (!oldest || (*prev)->last_use < (*oldest)->last_use)
+        oldest = prev;
+    }
+    if (idle <= keep)
+      break;
+    struct _fmpz_mod_poly_oz_ntt_precomp_entry *e = *oldest;
+    *oldest = e->next;
+    e->next = evicted;
+    evicted = e;
+  }
+  return evicted;
+}
+
+static fmpz_mod_poly_oz_ntt_precomp_struct *_fmpz_mod_poly_oz_ntt_precomp_ref_phi(const size_t n, const fmpz_t q, const fmpz_t phi,
+                                                                                 const int canonical) {
+  struct _fmpz_mod_poly_oz_ntt_precomp_entry *e;
+  int build = 0;
+
+  fmpz_t phi_;
+  fmpz_init(phi_);
+  fmpz_mod(phi_, phi, q);
+
+#pragma omp critical (oz_ntt_precomp_registry)
+  {
+    for(e = _fmpz_mod_poly_oz_ntt_precomp_registry; e; e = e->next) {
+      if (e->n == n && fmpz_equal(e->q, q) && fmpz_equal(e->phi, phi_))
+        break;
+    }
+
+    if (!e) {
+      e = (struct _fmpz_mod_poly_oz_ntt_precomp_entry*)calloc(1, sizeof(struct _fmpz_mod_poly_oz_ntt_precomp_entry));
+      e->n = n;
+      fmpz_init_set(e->q, q);
+      fmpz_init_set(e->phi, phi_);
+      e->next = _fmpz_mod_poly_oz_ntt_precomp_registry;
+      _fmpz_mod_poly_oz_ntt_precomp_registry = e;
+      build = 1;
+    }
+    e->canonical |= canonical;
+    e->refcount++;
+    e->last_use = ++_fmpz_mod_poly_oz_ntt_precomp_clock;
+  }
+
+  if (build) {
+    _fmpz_mod_poly_oz_ntt_precomp_init(e->precomp, n, q, phi_);
+    __atomic_store_n(&e->ready, 1, __ATOMIC_RELEASE);
+  } else {
+    while (!__atomic_load_n(&e->ready, __ATOMIC_ACQUIRE))
+      sched_yield();
+  }
+
+  fmpz_clear(phi_);
+  return e->precomp;
+}
+
+fmpz_mod_poly_oz_ntt_precomp_struct *fmpz_mod_poly_oz_ntt_precomp_ref(const size_t n, const fmpz_t q) {
+  struct _fmpz_mod_poly_oz_ntt_precomp_entry *e;
+
+#pragma omp critical (oz_ntt_precomp_registry)
+  {
+    for(e = _fmpz_mod_poly_oz_ntt_precomp_registry; e; e = e->next) {
+      if (e->canonical && e->n == n && fmpz_equal(e->q, q))
+        break;
+    }
+    if (e) {
+      e->refcount++;
+      e->last_use = ++_fmpz_mod_poly_oz_ntt_precomp_clock;
+    }
+  }
+
+  if (e) {
+    while (!__atomic_load_n(&e->ready, __ATOMIC_ACQUIRE))
+      sched_yield();
+    return e->precomp;
+  }
+
+  fmpz_t phi;  fmpz_init(phi);
+  _fmpz_mod_poly_oz_ntt_root(phi, n, q);
+  fmpz_mod_poly_oz_ntt_precomp_struct *precomp = _fmpz_mod_poly_oz_ntt_precomp_ref_phi(n, q, phi, 1);
+  fmpz_clear(phi);
+  return precomp;
+}
+
+fmpz_mod_poly_oz_ntt_precomp_struct *_fmpz_mod_poly_oz_ntt_precomp_ref(const size_t n, const fmpz_t q, const fmpz_t phi) {
+  return _fmpz_mod_poly_oz_ntt_precomp_ref_phi(n, q, phi, 0);
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_unref(fmpz_mod_poly_oz_ntt_precomp_struct *op) {
+  int found = 0;
+  struct _fmpz_mod_poly_oz_ntt_precomp_entry *evicted = NULL;
+
+#pragma omp critical (oz_ntt_precomp_registry)
+  {
+    struct _fmpz_mod_poly_oz_ntt_precomp_entry *e;
+    for(e = _fmpz_mod_poly_oz_ntt_precomp_registry; e; e = e->next) {
+      if (e->precomp == op)
+        break;
+    }
+
+    if (e && e->refcount) {
+      found = 1;
+      e->last_use = ++_fmpz_mod_poly_oz_ntt_precomp_clock;
+      if (--e->refcount == 0)
+        evicted = _fmpz_mod_poly_oz_ntt_precomp_evict(OZ_NTT_PRECOMP_IDLE);
+    }
+  }
+
+  if (!found)
+    oz_die("NTT pre-computation %p was not obtained from fmpz_mod_poly_oz_ntt_precomp_ref.\n", (void*)op);
+
+  while (evicted) {
+    struct _fmpz_mod_poly_oz_ntt_precomp_entry *next = evicted->next;
+    _fmpz_mod_poly_oz_ntt_precomp_entry_free(evicted);
+    evicted = next;
+  }
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_flush(void) {
+  struct _fmpz_mod_poly_oz_ntt_precomp_entry *evicted;
+
+#pragma omp critical (oz_ntt_precomp_registry)
+  evicted = _fmpz_mod_poly_oz_ntt_precomp_evict(0);
+
+  while (evicted) {
+    struct _fmpz_mod_poly_oz_ntt_precomp_entry *next = evicted->next;
+    _fmpz_mod_poly_oz_ntt_precomp_entry_free(evicted);
+    evicted = next;
+  }
 }
 
 void fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n) {
@@ -207,17 +607,263 @@ void fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const
   h->length = n;
 }
 
-void fmpz_mod_poly_oz_ntt_inv(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const size_t n) {
+void _fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
   const fmpz *q = fmpz_mod_poly_modulus(f);
-  fmpz_mod_poly_realloc(h, n);
+  const size_t n = precomp->n;
+  assert(n);
+  fmpz_mod_poly_fit_length(h, n);
+
+  fmpz_t tmp; fmpz_init(tmp);
+  fmpz_t quo; fmpz_init(quo);
+  for(size_t i=0; i<n; i++)
+    _fmpz_oz_mulmod_preinvn(h->coeffs + i, f->coeffs + i, g->coeffs + i, q, precomp->q_inv, tmp, quo);
+  h->length = n;
+  fmpz_clear(quo);
+  fmpz_clear(tmp);
+}
+
+void fmpz_mod_poly_oz_ntt_addmul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n) {
+  const fmpz *q = fmpz_mod_poly_modulus(f);
+  const size_t len = FLINT_MIN((size_t)fmpz_mod_poly_length(h), n);
+  fmpz_mod_poly_fit_length(h, n);
+  _fmpz_vec_zero(h->coeffs + len, n - len);
 
-#pragma omp parallel for
   for(size_t i=0; i<n; i++) {
-    fmpz_invmod(h->coeffs + i, f->coeffs + i, q);
+    fmpz_addmul(h->coeffs + i, f->coeffs + i, g->coeffs + i);
+    fmpz_mod(h->coeffs + i, h->coeffs + i, q);
   }
   h->length = n;
 }
 
+void _fmpz_mod_poly_oz_ntt_inner_product(fmpz_mod_poly_t rop, fmpz_mod_poly_t *f, fmpz_mod_poly_t *g, const size_t len,
+                                         const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(rop);
+  const size_t n = precomp->n;
+  fmpz_mod_poly_fit_length(rop, n);
+
+#pragma omp parallel if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  {
+    fmpz_t acc; fmpz_init(acc);
+    fmpz_t quo; fmpz_init(quo);
+
+#pragma omp for schedule(static)
+    for(size_t i=0; i<n; i++) {
+      /* accumulate unreduced products, reduce once per slot */
+      fmpz_zero(acc);
+      for(size_t k=0; k<len; k++) {
+        if ((long)i < f[k]->length && (long)i < g[k]->length)
+          fmpz_addmul(acc, f[k]->coeffs + i, g[k]->coeffs + i);
+      }
+      fmpz_fdiv_qr_preinvn(quo, rop->coeffs + i, acc, q, precomp->q_inv);
+    }
+
+    fmpz_clear(quo);
+    fmpz_clear(acc);
+  }
+  rop->length = n;
+}
+
+void _fmpz_mod_poly_oz_ntt_addmul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(f);
+  const size_t n = precomp->n;
+  const size_t len = FLINT_MIN((size_t)fmpz_mod_poly_length(h), n);
+  fmpz_mod_poly_fit_length(h, n);
+  _fmpz_vec_zero(h->coeffs + len, n - len);
+
+#pragma omp parallel if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+  {
+    fmpz_t acc; fmpz_init(acc);
+    fmpz_t quo; fmpz_init(quo);
+
+#pragma omp for schedule(static)
+    for(size_t i=0; i<n; i++) {
+      fmpz_mul(acc, f->coeffs + i, g->coeffs + i);
+      fmpz_add(acc, acc, h->coeffs + i);
+      fmpz_fdiv_qr_preinvn(quo, h->coeffs + i, acc, q, precomp->q_inv);
+    }
+
+    fmpz_clear(quo);
+    fmpz_clear(acc);
+  }
+  h->length = n;
+}
+
+/**
+   Invert slots $[start, end)$ of the concatenation of all `f[i]` using Montgomery's trick, `pre`
+   is scratch space for prefix products. Returns zero if some slot is not invertible, in which
+   case the output is undefined.
+*/
+
+static int _fmpz_mod_poly_oz_ntt_inv_range(fmpz_mod_poly_struct **h, const fmpz_mod_poly_struct *const *f, const size_t n,
+                                           const size_t start, const size_t end, fmpz *pre,
+                                           const fmpz_t q, const fmpz_preinvn_t q_inv) {
+  if (start >= end)
+    return 1;
+
+  fmpz_t inv, tmp, quo;
+  fmpz_init(inv);
+  fmpz_init(tmp);
+  fmpz_init(quo);
+
+  /* pre[l] = f_start · … · f_l */
+  fmpz_set(pre + start, f[start/n]->coeffs + start%n);
+  for(size_t l=start+1; l<end; l++)
+    _fmpz_oz_mulmod_preinvn(pre + l, pre + l - 1, f[l/n]->coeffs + l%n, q, q_inv, tmp, quo);
+
+  const int invertible = fmpz_invmod(inv, pre + end - 1, q);
+
+  if (invertible) {
+    for(size_t l=end-1; l>start; l--) {
+      /* read f_l before writing h_l as they might be aliased */
+      _fmpz_oz_mulmod_preinvn(pre + l - 1, inv, pre + l - 1, q, q_inv, tmp, quo);
+      _fmpz_oz_mulmod_preinvn(inv, inv, f[l/n]->coeffs + l%n, q, q_inv, tmp, quo);
+      fmpz_swap(h[l/n]->coeffs + l%n, pre + l - 1);
+    }
+    fmpz_swap(h[start/n]->coeffs + start%n, inv);
+  }
+
+  fmpz_clear(quo);
+  fmpz_clear(tmp);
+  fmpz_clear(inv);
+  return invertible;
+}
+
+/**
+   Same as `fmpz_mod_poly_oz_ntt_inv_batch` but on arrays of pointers, so that inputs can be const.
+*/
+
+static void _fmpz_mod_poly_oz_ntt_inv_batch(fmpz_mod_poly_struct **h, const fmpz_mod_poly_struct *const *f,
+                                            const size_t len, const size_t n) {
+  if (len == 0)
+    return;
+
+  const fmpz *q = &f[0]->p;
+  const size_t N = len * n;
+
+  for(size_t i=0; i<len; i++)
+    fmpz_mod_poly_realloc(h[i], n);
+
+  fmpz_preinvn_t q_inv;
+  fmpz_preinvn_init(q_inv, q);
+  fmpz *pre = _fmpz_vec_init(N);
+
+  const int num_chunks = (N >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel()) ? omp_get_max_threads() : 1;
+  const size_t chunk = (N + num_chunks - 1)/num_chunks;
+
+#pragma omp parallel for num_threads(num_chunks) schedule(static, 1) if (num_chunks > 1)
+  for(int t=0; t<num_chunks; t++) {
+    const size_t start = FLINT_MIN(t*chunk, N);
+    const size_t end = FLINT_MIN(start + chunk, N);
+    if (!_fmpz_mod_poly_oz_ntt_inv_range(h, f, n, start, end, pre, q, q_inv)) {
+      /* some slot is zero modulo a factor of q, fall back to inverting each slot */
+      for(size_t l=start; l<end; l++)
+        fmpz_invmod(h[l/n]->coeffs + l%n, f[l/n]->coeffs + l%n, q);
+    }
+  }
+
+  for(size_t i=0; i<len; i++)
+    h[i]->length = n;
+
+  _fmpz_vec_clear(pre, N);
+  fmpz_preinvn_clear(q_inv);
+}
+
+void fmpz_mod_poly_oz_ntt_inv_batch(fmpz_mod_poly_t *h, fmpz_mod_poly_t *f, const size_t len, const size_t n) {
+  if (len == 0)
+    return;
+
+  fmpz_mod_poly_struct **h_ = malloc(len * sizeof(fmpz_mod_poly_struct *));
+  const fmpz_mod_poly_struct **f_ = malloc(len * sizeof(fmpz_mod_poly_struct *));
+  for(size_t i=0; i<len; i++) {
+    h_[i] = h[i];
+    f_[i] = f[i];
+  }
+  _fmpz_mod_poly_oz_ntt_inv_batch(h_, f_, len, n);
+  free(f_);
+  free(h_);
+}
+
+void fmpz_mod_poly_oz_ntt_inv(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const size_t n) {
+  fmpz_mod_poly_struct *h_ = h;
+  const fmpz_mod_poly_struct *f_ = f;
+  _fmpz_mod_poly_oz_ntt_inv_batch(&h_, &f_, 1, n);
+}
+
+/**
+   Slot $i$ holds $a(φ^{e_i})$ with $e_i = 2\\mbox{rev}(i)+1$, so slot $i$ of $a(x^k)$ is the slot
+   of $a$ with exponent $k·e_i \\bmod 2n$.
+*/
+
+static inline size_t _fmpz_mod_poly_oz_ntt_automorphism_slot(const size_t *br, const size_t n, const size_t i, const size_t k) {
+  const size_t e = (k * (2*br[i] + 1)) % (2*n);
+  return br[(e - 1)/2];
+}
+
+void _fmpz_mod_poly_oz_ntt_automorphism(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const long k,
+                                        const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const long m = (long)(2*n);
+  const size_t k_ = (size_t)(((k % m) + m) % m);
+
+  if (k_ % 2 == 0)
+    oz_die("x → x^%ld is not an automorphism of Z[x]/(x^%zu+1).\n", k, n);
+
+  if (k_ == 1) {
+    fmpz_mod_poly_set(rop, op);
+    return;
+  }
+  if (k_ == 2*n - 1) {
+    fmpz_mod_poly_oz_ntt_conjugate(rop, op, n);
+    return;
+  }
+
+  if (rop == op) {
+    /* slots beyond the length are zero, move the fmpz words around without copying */
+    fmpz_mod_poly_fit_length(rop, n);
+    fmpz *t = (fmpz*)flint_malloc(n * sizeof(fmpz));
+
+#pragma omp parallel for if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+    for(size_t i=0; i<n; i++)
+      t[i] = rop->coeffs[_fmpz_mod_poly_oz_ntt_automorphism_slot(precomp->br, n, i, k_)];
+
+    memcpy(rop->coeffs, t, n * sizeof(fmpz));
+    flint_free(t);
+  } else {
+    fmpz_mod_poly_fit_length(rop, n);
+
+#pragma omp parallel for if (n >= OZ_NTT_PARALLEL_THRESHOLD && !omp_in_parallel())
+    for(size_t i=0; i<n; i++) {
+      const size_t j = _fmpz_mod_poly_oz_ntt_automorphism_slot(precomp->br, n, i, k_);
+      if (j < (size_t)op->length)
+        fmpz_set(rop->coeffs + i, op->coeffs + j);
+      else
+        fmpz_zero(rop->coeffs + i);
+    }
+  }
+  _fmpz_mod_poly_set_length(rop, n);
+  _fmpz_mod_poly_normalise(rop);
+}
+
+void fmpz_mod_poly_oz_ntt_conjugate(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
+  /* exponents 2rev(i)+1 and 2rev(n-1-i)+1 sum to 2n, i.e. conjugation reverses the slots */
+  if (rop == op) {
+    fmpz_mod_poly_fit_length(rop, n);
+    for(size_t i=0; i<n/2; i++)
+      fmpz_swap(rop->coeffs + i, rop->coeffs + n - 1 - i);
+  } else {
+    fmpz_mod_poly_fit_length(rop, n);
+    for(size_t i=0; i<n; i++) {
+      if (n - 1 - i < (size_t)op->length)
+        fmpz_set(rop->coeffs + i, op->coeffs + n - 1 - i);
+      else
+        fmpz_zero(rop->coeffs + i);
+    }
+  }
+  _fmpz_mod_poly_set_length(rop, n);
+  _fmpz_mod_poly_normalise(rop);
+}
+
 void fmpz_mod_poly_oz_ntt_set_ui(fmpz_mod_poly_t op, const unsigned long c, const size_t n) {
   fmpz_mod_poly_realloc(op, n);
   for(size_t i=0; i<n; i++)
@@ -241,45 +887,41 @@ void fmpz_mod_poly_oz_ntt_pow_ui(fmpz_mod_poly_t rop, const fmpz_mod_poly_t f, u
 }
 
 void fmpz_mod_poly_oz_ntt_enc_fmpz_poly(fmpz_mod_poly_t rop, const fmpz_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
-  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
-  fmpz_mod_poly_realloc(rop, precomp->n);
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->psi_br);
+  const size_t n = precomp->n;
+  const size_t len = FLINT_MIN((size_t)fmpz_poly_length(op), n);
+  fmpz_mod_poly_fit_length(rop, n);
 
-  fmpz_poly_t t; fmpz_poly_init2(t, precomp->n);
-  fmpz_poly_set(t, op);
+  for(size_t i=0; i<len; i++)
+    fmpz_mod(rop->coeffs+i, op->coeffs+i, q);
+  _fmpz_vec_zero(rop->coeffs + len, n - len);
+  rop->length = n;
 
-/* #pragma omp parallel for */
-  for(size_t i=0; i<precomp->n; i++) {
-    fmpz_mul(rop->coeffs+i, precomp->phi->coeffs+i, t->coeffs+i);
-    fmpz_mod(rop->coeffs+i, rop->coeffs+i, q);
-  }
-  rop->length = precomp->n;
-  _fmpz_mod_poly_oz_ntt(rop, rop, precomp->w, precomp->n);
-  fmpz_poly_clear(t);
+  fmpz_t tmp; fmpz_init(tmp);
+  fmpz_t quo; fmpz_init(quo);
+  _fmpz_vec_oz_ntt_nwc(rop->coeffs, precomp, tmp, quo);
+  fmpz_clear(quo);
+  fmpz_clear(tmp);
 }
 
 void fmpz_mod_poly_oz_ntt_enc(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
-  const fmpz *q = fmpz_mod_poly_modulus(op);
-  fmpz_mod_poly_realloc(rop, precomp->n);
+  fmpz_mod_poly_oz_ntt_set_input(rop, op, precomp->n);
 
-/* #pragma omp parallel for */
-  for(size_t i=0; i<precomp->n; i++) {
-    fmpz_mul(rop->coeffs+i, precomp->phi->coeffs+i, op->coeffs+i);
-    fmpz_mod(rop->coeffs+i, rop->coeffs+i, q);
-  }
-  rop->length = precomp->n;
-  _fmpz_mod_poly_oz_ntt(rop, rop, precomp->w, precomp->n);
+  fmpz_t tmp; fmpz_init(tmp);
+  fmpz_t quo; fmpz_init(quo);
+  _fmpz_vec_oz_ntt_nwc(rop->coeffs, precomp, tmp, quo);
+  fmpz_clear(quo);
+  fmpz_clear(tmp);
 }
 
 void fmpz_mod_poly_oz_ntt_dec(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
-  const fmpz *q = fmpz_mod_poly_modulus(op);
+  fmpz_mod_poly_oz_ntt_set_input(rop, op, precomp->n);
 
-  _fmpz_mod_poly_oz_ntt(rop, op, precomp->w_inv, precomp->n);
-
-/* #pragma omp parallel for */
-  for(size_t i=0; i<precomp->n; i++) {
-    fmpz_mul(rop->coeffs+i, precomp->phi_inv->coeffs+i, rop->coeffs+i);
-    fmpz_mod(rop->coeffs+i, rop->coeffs+i, q);
-  }
+  fmpz_t tmp; fmpz_init(tmp);
+  fmpz_t quo; fmpz_init(quo);
+  _fmpz_vec_oz_intt_nwc(rop->coeffs, precomp, tmp, quo);
+  fmpz_clear(quo);
+  fmpz_clear(tmp);
 }
 
 
@@ -293,7 +935,7 @@ void _fmpz_mod_poly_oz_mul_nttnwc(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, co
   fmpz_mod_poly_oz_ntt_enc(F, f, precomp);
   fmpz_mod_poly_oz_ntt_enc(G, g, precomp);
 
-  fmpz_mod_poly_oz_ntt_mul(h, F, G, n);
+  _fmpz_mod_poly_oz_ntt_mul(h, F, G, precomp);
 
   fmpz_mod_poly_clear(F);
   fmpz_mod_poly_clear(G);
@@ -307,10 +949,9 @@ void fmpz_mod_poly_oz_mul_nttnwc(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, con
   assert(fmpz_mod_poly_length(f) == (long)n);
 
   const fmpz *q = fmpz_mod_poly_modulus(f);
-  fmpz_mod_poly_oz_ntt_precomp_t precomp;
-  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
+  fmpz_mod_poly_oz_ntt_precomp_struct *precomp = fmpz_mod_poly_oz_ntt_precomp_ref(n, q);
 
   _fmpz_mod_poly_oz_mul_nttnwc(h, f, g, precomp);
 
-  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_mod_poly_oz_ntt_precomp_unref(precomp);
 }
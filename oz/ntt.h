@@ -9,6 +9,10 @@
    \mbox{NTT}_{ω_n}^{-1}(\mbox{NTT}_{ω_n}(\overline{a}) \odot \mbox{NTT}_{ω_n}(\overline{b}))@f$
    where @f$\mbox{NTT}_{ω_n}(·)@f$ is the number-theoretic transform and
    @f$\mbox{NTT}_{ω_n}^{-1}(·)@f$ is its inverse.
+
+   The functions taking a `precomp` argument merge the multiplication by powers of $φ$ into the
+   butterflies and leave elements in the NTT domain in bit-reversed order. Since all operations in
+   the NTT domain are slot-wise this order is only observable by inspecting individual slots.
  */
 
 #ifndef NTT_H
@@ -19,6 +23,27 @@
 #include <mpfr.h>
 #include <flint/fmpz_mod_poly.h>
 
+/**
+   @brief Transforms of length at least this are spread across OpenMP threads.
+
+   Below this size the cost of synchronising threads after each stage dominates. Transforms
+   called from within a parallel region are always serial.
+*/
+
+#ifndef OZ_NTT_PARALLEL_THRESHOLD
+#define OZ_NTT_PARALLEL_THRESHOLD 1024
+#endif
+
+/**
+   Number of unreferenced entries kept in the registry of pre-computed NTT data.
+
+   @see fmpz_mod_poly_oz_ntt_precomp_unref
+*/
+
+#ifndef OZ_NTT_PRECOMP_IDLE
+#define OZ_NTT_PRECOMP_IDLE 4
+#endif
+
 /**
    @brief Pre-computed data for number-theoretic transform
 */
@@ -27,10 +52,20 @@ struct fmpz_mod_poly_oz_ntt_precomp_struct {
   size_t n;                   //!< dimension, must be a  power of two
   fmpz_mod_poly_t w;          //!< a vector holding $ω_n^i$ at index $i$ where $ω_n$ as an $n$-th root of unity.
   fmpz_mod_poly_t w_inv;      //!< a vector holding $ω_n^{-i}$ at index $i$ where $ω_n$ as an $n$-th root of unity.
-  fmpz_mod_poly_t phi;        //!< a vector holding $φ^i$ at index $i$ where @f$φ = \sqrt{ω_n} \bmod q@f$.
-  fmpz_mod_poly_t phi_inv;    //!< a vector holding $φ^{-i}$ at index $i$ where @f$φ = \sqrt{ω_n} \bmod q@f$.
+  fmpz_mod_poly_t psi_br;     //!< a vector holding $φ^{\\mbox{rev}(i)}$ at index $i$ where @f$φ = \sqrt{ω_n} \bmod q@f$ and $\\mbox{rev}$ reverses $\\log_2 n$ bits.
+  fmpz_mod_poly_t psi_inv_br; //!< a vector holding $φ^{-\\mbox{rev}(i)}$ at index $i$, index $1$ is multiplied by $1/n$.
+  fmpz_t phi;                 //!< the primitive $2n$-th root of unity $φ \\bmod q$ defining the slot order
+  fmpz_t n_inv;               //!< $1/n \\bmod q$
+  fmpz_preinvn_t q_inv;       //!< pre-computed inverse of $q$ for fast reduction modulo $q$
+  size_t *br;                 //!< bit-reversal permutation $i ↦ \\mbox{rev}(i)$ on $\\log_2 n$ bits, used to map slots under automorphisms
 };
 
+/**
+   @brief Pre-computed data for number-theoretic transform, as handed out by the shared registry.
+*/
+
+typedef struct fmpz_mod_poly_oz_ntt_precomp_struct fmpz_mod_poly_oz_ntt_precomp_struct;
+
 /**
    @brief Pre-computed data for number-theoretic transform
 */
@@ -43,12 +78,59 @@ typedef struct fmpz_mod_poly_oz_ntt_precomp_struct fmpz_mod_poly_oz_ntt_precomp_
 
 void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q);
 
+/**
+   @brief Pre-compute NTT data for $\\ZZ_q[x]/\\ideal{x^n+1}$ given a primitive $2n$-th root of unity $φ$.
+
+   @note This function does not require $q$ to be prime, which makes it suitable for composite $q$
+   where the root of unity is obtained via the CRT.
+*/
+
+void _fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q, const fmpz_t phi);
+
 /**
    @brief Clear pre-computed data.
 */
 
 void fmpz_mod_poly_oz_ntt_precomp_clear(fmpz_mod_poly_oz_ntt_precomp_t op);
 
+/**
+   @brief Return shared pre-computed NTT data for $\\ZZ_q[x]/\\ideal{x^n+1}$.
+
+   Pre-computed data is kept in a process-wide registry and is only computed on the first request,
+   using all available threads. This function always uses the root of unity $φ$ picked by
+   `fmpz_mod_poly_oz_ntt_precomp_init`, so the slot order does not depend on which other entries
+   exist. The returned data must be treated as read-only and released with
+   `fmpz_mod_poly_oz_ntt_precomp_unref`. This function is thread-safe.
+*/
+
+fmpz_mod_poly_oz_ntt_precomp_struct *fmpz_mod_poly_oz_ntt_precomp_ref(const size_t n, const fmpz_t q);
+
+/**
+   @brief Return shared pre-computed NTT data for $\\ZZ_q[x]/\\ideal{x^n+1}$ given a primitive $2n$-th root of unity $φ$.
+
+   Entries are keyed by $(n,q,φ)$ as different roots of unity order the slots differently.
+
+   @see fmpz_mod_poly_oz_ntt_precomp_ref
+   @see _fmpz_mod_poly_oz_ntt_precomp_init
+*/
+
+fmpz_mod_poly_oz_ntt_precomp_struct *_fmpz_mod_poly_oz_ntt_precomp_ref(const size_t n, const fmpz_t q, const fmpz_t phi);
+
+/**
+   @brief Release pre-computed data obtained from `fmpz_mod_poly_oz_ntt_precomp_ref`.
+
+   Data without references is kept for later requests, up to `OZ_NTT_PRECOMP_IDLE` entries, the
+   least recently used are cleared first.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_unref(fmpz_mod_poly_oz_ntt_precomp_struct *op);
+
+/**
+   @brief Clear all pre-computed data in the registry which is not referenced.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_flush(void);
+
 /**
    @brief Compute @f$\mbox{rop} = \NTT{\mbox{op}}@f$.
 */
@@ -97,12 +179,93 @@ void fmpz_mod_poly_oz_ntt_set_ui(fmpz_mod_poly_t rop, const unsigned long c, con
 
 void fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n);
 
+/**
+   @brief Compute $h = \\NTT{f' · g'}$ from $f = \\NTT{f'}$ and $g = \\NTT{g'}$ using `precomp`.
+
+   Reduction modulo $q$ uses the pre-computed inverse of $q$ in `precomp` instead of a generic
+   division.
+*/
+
+void _fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = h + \\NTT{f' · g'}$ from $f = \\NTT{f'}$ and $g = \\NTT{g'}$.
+
+   Only one reduction modulo $q$ is performed per slot.
+*/
+
+void fmpz_mod_poly_oz_ntt_addmul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n);
+
+/**
+   @brief Compute $h = h + \\NTT{f' · g'}$ from $f = \\NTT{f'}$ and $g = \\NTT{g'}$ using `precomp`.
+*/
+
+void _fmpz_mod_poly_oz_ntt_addmul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $\\mbox{rop} = \\sum_{0 ≤ k < \\mbox{len}} f_k · g_k$ in the NTT domain using `precomp`.
+
+   Products are accumulated unreduced per slot and reduced modulo $q$ once at the end. Slots are
+   processed in parallel if $n ≥$ `OZ_NTT_PARALLEL_THRESHOLD`. `rop` may alias any $f_k$ or $g_k$.
+
+   @param rop           initialised polynomial modulo $q$
+   @param f             array of `len` elements in the NTT domain
+   @param g             array of `len` elements in the NTT domain
+   @param len           number of products
+   @param precomp       pre-computed NTT data
+*/
+
+void _fmpz_mod_poly_oz_ntt_inner_product(fmpz_mod_poly_t rop, fmpz_mod_poly_t *f, fmpz_mod_poly_t *g, const size_t len,
+                                         const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
 /**
    @brief Compute $h = \\NTT{f'^{-1}}$  where $f' \\in \\ZZ_q[x]/\\ideal{x^n+1}$ from $f = \\NTT{f'}$.
 */
 
 void fmpz_mod_poly_oz_ntt_inv(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const size_t n);
 
+/**
+   @brief Compute $h_i = \\NTT{f_i'^{-1}}$ for $0 ≤ i <$ `len` where $f_i = \\NTT{f_i'}$.
+
+   Uses Montgomery's trick: slots are split into one contiguous range per OpenMP thread, each
+   range computes prefix products, inverts their product with a single extended GCD and recovers
+   all inverses in a backward sweep. This costs about three multiplications modulo $q$ per slot
+   instead of one extended GCD per slot. Ranges containing a slot which is not invertible modulo
+   $q$ fall back to inverting each slot.
+
+   @param h             output array of length `len`, may be aliased with `f`
+   @param f             input array of length `len`, all with the same modulus $q$
+   @param len           number of elements
+   @param n             number of slots in each element
+*/
+
+void fmpz_mod_poly_oz_ntt_inv_batch(fmpz_mod_poly_t *h, fmpz_mod_poly_t *f, const size_t len, const size_t n);
+
+/**
+   @brief Compute $\\mbox{rop} = \\NTT{\\mbox{op}'(x^k)}$ where $\\mbox{op} = \\NTT{\\mbox{op}'}$.
+
+   Automorphisms $x ↦ x^k$ for odd $k$ permute the slots, so no transform is needed.
+
+   @param rop           output, may be aliased with `op`
+   @param op            element in the NTT domain
+   @param k             exponent, must be odd, negative values are taken modulo $2n$
+   @param precomp       pre-computed NTT data
+*/
+
+void _fmpz_mod_poly_oz_ntt_automorphism(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const long k,
+                                        const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $\\mbox{rop} = \\NTT{\\mbox{op}'^T}$ where $\\mbox{op} = \\NTT{\\mbox{op}'}$ and $^T$ is conjugation $x ↦ x^{-1}$.
+
+   As slots are in bit-reversed order, conjugation reverses the order of slots.
+
+   @see fmpz_poly_oz_conjugate
+*/
+
+void fmpz_mod_poly_oz_ntt_conjugate(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n);
+
 /**
    @brief Compute $h = \\NTT{f'^e}$  where $f' \\in \\ZZ_q[x]/\\ideal{x^n+1}$ from $f = \\NTT{f'}$.
 */
@@ -115,6 +278,53 @@ void fmpz_mod_poly_oz_ntt_pow_ui(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, uns
 
 void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w, const size_t n);
 
+/**
+   @brief Perform $a = \\NTT{a}$ in place given $ω^i$ for $0 ≤ i < n/2$ in `w`.
+
+   All entries of $a$ must be in $[0,q)$. The only scratch space used is `tmp`, which allows
+   callers to reuse it across calls and no memory is allocated per butterfly.
+
+   If $n ≥$ `OZ_NTT_PARALLEL_THRESHOLD` the butterflies of each stage are split across OpenMP
+   threads, each using its own scratch space. The output is identical to the serial transform.
+
+   @param a             vector of length $n$
+   @param w             powers $ω^i$ for $0 ≤ i < n/2$ in natural order, longer vectors are fine
+   @param n             length, must be a power of two
+   @param q             modulus
+   @param tmp           initialised scratch space
+*/
+
+void _fmpz_vec_oz_ntt(fmpz *a, const fmpz *w, const size_t n, const fmpz_t q, fmpz_t tmp);
+
+/**
+   @brief Perform the negacyclic transform of $a$ in place using `precomp`.
+
+   On input $a$ holds the coefficients of @f$a(x) \in \ZZ_q[x]/\ideal{x^n+1}@f$ in $[0,q)$. On output
+   index $i$ holds @f$a(φ^{2\mbox{rev}(i)+1})@f$, i.e. the twist by powers of $φ$ is merged into the
+   Cooley-Tukey butterflies and the output is left in bit-reversed order.
+
+   @param a             vector of length $n$
+   @param precomp       pre-computed NTT data
+   @param tmp           initialised scratch space
+   @param quo           initialised scratch space
+*/
+
+void _fmpz_vec_oz_ntt_nwc(fmpz *a, const fmpz_mod_poly_oz_ntt_precomp_t precomp, fmpz_t tmp, fmpz_t quo);
+
+/**
+   @brief Invert `_fmpz_vec_oz_ntt_nwc` in place using `precomp`.
+
+   Uses Gentleman-Sande butterflies on bit-reversed input so that no permutation is needed, the
+   scaling by $1/n$ is merged into the last stage.
+
+   @param a             vector of length $n$
+   @param precomp       pre-computed NTT data
+   @param tmp           initialised scratch space
+   @param quo           initialised scratch space
+*/
+
+void _fmpz_vec_oz_intt_nwc(fmpz *a, const fmpz_mod_poly_oz_ntt_precomp_t precomp, fmpz_t tmp, fmpz_t quo);
+
 /**
    @brief Compute $h = f · g$ using the number-theoretic transform using `precomp`.
 */
@@ -5,27 +5,32 @@
 
 
 void fmpz_poly_oz_conjugate(fmpz_poly_t fT, const fmpz_poly_t f, const long n) {
-  fmpz_poly_zero(fT);
-  fmpz_t t0; fmpz_init(t0);
-  fmpz_t t1; fmpz_init(t1);
+  if (fT == f) {
+    fmpz_poly_t t;
+    fmpz_poly_init(t);
+    fmpz_poly_oz_conjugate(t, f, n);
+    fmpz_poly_swap(fT, t);
+    fmpz_poly_clear(t);
+    return;
+  }
 
-  fmpz_poly_get_coeff_fmpz(t0, f, 0);
-  fmpz_poly_set_coeff_fmpz(fT, 0, t0);
+  /* f(x^{-1}) = f_0 - Σ f_i x^{n-i} */
+  fmpz_poly_fit_length(fT, n);
+  const long len = FLINT_MIN(f->length, n);
 
-  for(int i=1; i<n/2; i++) {
-    fmpz_poly_get_coeff_fmpz(t0, f,   i);
-    fmpz_poly_get_coeff_fmpz(t1, f, n-i);
-    fmpz_neg(t0, t0);
-    fmpz_neg(t1, t1);
-    fmpz_poly_set_coeff_fmpz(fT, n-i, t0);
-    fmpz_poly_set_coeff_fmpz(fT, i, t1);
-  }
-  fmpz_poly_get_coeff_fmpz(t0, f, n/2);
-  fmpz_neg(t0, t0);
-  fmpz_poly_set_coeff_fmpz(fT, n/2, t0);
+  if (len > 0)
+    fmpz_set(fT->coeffs, f->coeffs);
+  else
+    fmpz_zero(fT->coeffs);
 
-  fmpz_clear(t1);
-  fmpz_clear(t0);
+  for(long i=1; i<n; i++) {
+    if (n-i < len)
+      fmpz_neg(fT->coeffs + i, f->coeffs + n - i);
+    else
+      fmpz_zero(fT->coeffs + i);
+  }
+  _fmpz_poly_set_length(fT, n);
+  _fmpz_poly_normalise(fT);
 }
 
 void fmpq_poly_oz_conjugate(fmpq_poly_t fT, const fmpq_poly_t f, const long n) {
@@ -188,5 +188,7 @@ int fmpz_poly_oz_coprime_det(const fmpz_poly_t b0, const fmpz_t det_b1, const lo
 #include <oz/sqrt.h>
 #include <oz/norm.h>
 #include <oz/rem.h>
+#include <oz/rns.h>
+#include <oz/arena.h>
 
 #endif /* _OZ_H_ */
@@ -69,10 +69,42 @@ void _fmpz_poly_oz_rem_small_fmpz(fmpz_poly_t rem, const fmpz_t f, const fmpz_po
   fmpz_clear(fc);
 }
 
-void _fmpz_poly_oz_rem_small_fmpz_split(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_t g,
-                                        const long n, const fmpq_poly_t g_inv, const mp_bitcnt_t b) {
+void fmpz_poly_oz_rem_small_ctx_init(fmpz_poly_oz_rem_small_ctx_t ctx, const fmpz_poly_t g, const long n,
+                                     const fmpq_poly_t g_inv, const mp_bitcnt_t b) {
+  ctx->g = g;
+  ctx->g_inv = g_inv;
+  ctx->n = n;
+  ctx->b = b;
+  ctx->len = omp_get_max_threads();
+  ctx->rem_bound = log2(n) * labs(fmpz_poly_max_bits(g)) + 128;
+
+  // powb[i] ~= 2^((i+1)b)
+  ctx->powb = (fmpz_poly_struct*)calloc(ctx->len, sizeof(fmpz_poly_struct));
+  for(size_t j=0; j<ctx->len; j++)
+    fmpz_poly_init(ctx->powb + j);
+
+  fmpz_poly_set_coeff_ui(ctx->powb + 0, 0, 2); // powb ~= 2^b
+  fmpz_pow_ui(ctx->powb[0].coeffs, ctx->powb[0].coeffs, b);
+  _fmpz_poly_oz_rem_small_fmpz(ctx->powb + 0, ctx->powb[0].coeffs, g, n, g_inv, ctx->rem_bound);
 
-  const size_t num_threads = omp_get_max_threads();
+  for(size_t j=1; j<ctx->len; j++) {
+    fmpz_poly_oz_mul(ctx->powb + j, ctx->powb + j - 1, ctx->powb + 0, n);
+    _fmpz_poly_oz_rem_small_iter(ctx->powb + j, ctx->powb + j, g, n, g_inv, 0, 0);
+  }
+}
+
+void fmpz_poly_oz_rem_small_ctx_clear(fmpz_poly_oz_rem_small_ctx_t ctx) {
+  for(size_t j=0; j<ctx->len; j++)
+    fmpz_poly_clear(ctx->powb + j);
+  free(ctx->powb);
+  ctx->powb = NULL;
+  ctx->len = 0;
+}
+
+void _fmpz_poly_oz_rem_small_fmpz_split_ctx(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_oz_rem_small_ctx_t ctx) {
+  const size_t len = ctx->len;
+  const mp_bitcnt_t b = ctx->b;
+  const long n = ctx->n;
 
   fmpz_t F; fmpz_init_set(F, f);
   fmpz_t H; fmpz_init(H);
@@ -80,68 +112,49 @@ void _fmpz_poly_oz_rem_small_fmpz_split(fmpz_poly_t rem, const fmpz_t f, const f
   fmpz_poly_set_ui(t, 1);
   fmpz_poly_t acc; fmpz_poly_init(acc);
 
-  fmpz_t H_[num_threads];
-  fmpz_poly_t f_[num_threads];
-  fmpz_poly_t t_[num_threads];
+  fmpz_t H_[len];
+  fmpz_poly_t f_[len];
+  fmpz_poly_t t_[len];
 
-  for(size_t j=0; j<num_threads; j++) {
+  for(size_t j=0; j<len; j++) {
     fmpz_init(H_[j]);
     fmpz_poly_init(f_[j]);
     fmpz_poly_init(t_[j]);
   }
 
-  const mp_bitcnt_t B = num_threads*b;
-  const mp_bitcnt_t rem_bound = log2(n) * labs(fmpz_poly_max_bits(g)) + 128;
-
-  // powb[i] ~= 2^((i+1)b)
-  fmpz_poly_t powb[num_threads];
-
-  for(size_t j=0; j<num_threads; j++) {
-    fmpz_poly_init(powb[j]);
-  }
-  fmpz_poly_set_coeff_ui(powb[0], 0, 2); // powb ~= 2^b
-  fmpz_pow_ui(powb[0]->coeffs, powb[0]->coeffs, b);
-  _fmpz_poly_oz_rem_small_fmpz(powb[0], powb[0]->coeffs, g, n, g_inv, rem_bound);
-
-  for(size_t j=1; j<num_threads; j++) {
-    fmpz_poly_oz_mul(powb[j], powb[j-1], powb[0], n);
-    _fmpz_poly_oz_rem_small_iter(powb[j], powb[j], g, n, g_inv, 0, 0);
-  }
-
+  const mp_bitcnt_t B = len*b;
   const size_t nparts = (fmpz_sizeinbase(f, 2)/B) + ((fmpz_sizeinbase(f, 2)%B) ? 1 : 0);
 
-  for(size_t i=0; i<nparts; i++) {
+  for(size_t i=0; i<nparts && !oz_cancelled(); i++) {
     fmpz_set(H, F);
     fmpz_fdiv_r_2exp(H, H, B); // H = H % 2^B
 
-    for(size_t j=0; j<num_threads; j++)
+    for(size_t j=0; j<len; j++)
       fmpz_poly_set(t_[j], t);
 
-/* #pragma omp parallel for */
-    for(size_t j=1; j<num_threads; j++) {
-      fmpz_poly_oz_mul(t_[j], t_[j], powb[j-1], n);
+    for(size_t j=1; j<len; j++) {
+      fmpz_poly_oz_mul(t_[j], t_[j], ctx->powb + j - 1, n);
     }
 
-/* #pragma omp parallel for */
-    for(size_t j=0; j<num_threads; j++) {
+    for(size_t j=0; j<len; j++) {
       fmpz_set(H_[j], H);
       fmpz_fdiv_q_2exp(H_[j], H_[j], j*b);
       fmpz_fdiv_r_2exp(H_[j], H_[j], b); // H_j = (H >> j*b) % 2^b
 
-      _fmpz_poly_oz_rem_small_fmpz(f_[j], H_[j], g, n, g_inv, rem_bound); // f_j ~= H_j
+      _fmpz_poly_oz_rem_small_fmpz(f_[j], H_[j], ctx->g, n, ctx->g_inv, ctx->rem_bound); // f_j ~= H_j
       fmpz_poly_oz_mul(f_[j], t_[j], f_[j], n); // f_j ~= 2^(b*j) * H_j
     }
 
-    for(size_t j=0; j<num_threads; j++)
+    for(size_t j=0; j<len; j++)
       fmpz_poly_add(acc, acc, f_[j]);
 
-    fmpz_poly_oz_mul(t, t, powb[num_threads-1], n);
+    fmpz_poly_oz_mul(t, t, ctx->powb + len - 1, n);
     if (labs(fmpz_poly_max_bits(t)) > (long)b/2)
-      _fmpz_poly_oz_rem_small(t, t, g, n, g_inv);
+      _fmpz_poly_oz_rem_small(t, t, ctx->g, n, ctx->g_inv);
 
     fmpz_fdiv_q_2exp(F, F, B); // F >> B
   }
-  assert(fmpz_is_zero(F));
+  assert(fmpz_is_zero(F) || oz_cancelled());
   fmpz_poly_set(rem, acc);
 
   fmpz_clear(F);
@@ -149,13 +162,19 @@ void _fmpz_poly_oz_rem_small_fmpz_split(fmpz_poly_t rem, const fmpz_t f, const f
   fmpz_poly_clear(acc);
   fmpz_poly_clear(t);
 
-  for(size_t j=0; j<num_threads; j++) {
+  for(size_t j=0; j<len; j++) {
     fmpz_clear(H_[j]);
     fmpz_poly_clear(f_[j]);
     fmpz_poly_clear(t_[j]);
-    fmpz_poly_clear(powb[j]);
   }
+}
 
+void _fmpz_poly_oz_rem_small_fmpz_split(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_t g,
+                                        const long n, const fmpq_poly_t g_inv, const mp_bitcnt_t b) {
+  fmpz_poly_oz_rem_small_ctx_t ctx;
+  fmpz_poly_oz_rem_small_ctx_init(ctx, g, n, g_inv, b);
+  _fmpz_poly_oz_rem_small_fmpz_split_ctx(rem, f, ctx);
+  fmpz_poly_oz_rem_small_ctx_clear(ctx);
 }
 
 void _fmpz_poly_oz_rem_small(fmpz_poly_t rem, const fmpz_poly_t f, const fmpz_poly_t g, const long n, const fmpq_poly_t g_inv) {
@@ -194,34 +213,22 @@ void fmpz_poly_oz_rem_small(fmpz_poly_t rem, const fmpz_poly_t f, const fmpz_pol
 }
 
 
-void _fmpz_poly_oz_rem_small_iter(fmpz_poly_t rem, const fmpz_poly_t f, const fmpz_poly_t g,
-                                  const long n, const fmpq_poly_t ginv, const mp_bitcnt_t b, const oz_flag_t flags) {
+/**
+   Reduce `f` by $g$ until the result does not get any smaller, `f` is a first approximation.
+*/
 
-  mp_bitcnt_t prec = (b) ? b : labs(_fmpz_vec_max_bits(ginv->coeffs, fmpq_poly_length(ginv)))/2;
+static void _fmpz_poly_oz_rem_small_refine(fmpz_poly_t rem, const fmpz_poly_t f, const fmpz_poly_t g,
+                                           const long n, const fmpq_poly_t ginv, const mp_bitcnt_t prec,
+                                           const oz_flag_t flags) {
   fmpz_poly_t t_i;  fmpz_poly_init(t_i);
   fmpz_poly_t t_o;  fmpz_poly_init(t_o);
   mpfr_t norm_i; mpfr_init2(norm_i, prec);
   mpfr_t norm_o; mpfr_init2(norm_o, prec);
 
-  fmpz_poly_set(t_i, f);
+  fmpz_poly_set(t_o, f);
   fmpq_poly_t g_inv; fmpq_poly_init(g_inv);
   fmpq_poly_set(g_inv, ginv);
 
-  if (fmpz_poly_degree(f) == 0) {
-    uint64_t t = oz_walltime(0);
-    _fmpz_poly_oz_rem_small_fmpz_split(t_o, f->coeffs, g, n, g_inv, prec);
-    t = oz_walltime(t);
-
-    if (flags & OZ_VERBOSE) {
-      fprintf(stderr, "|f|: %10.1f, |g|: %10.1f, |f%%g|: %10.1f, t: %10.6f\n",
-             fmpz_poly_2norm_log2(t_i), fmpz_poly_2norm_log2(g), fmpz_poly_2norm_log2(t_o),
-             oz_seconds(t));
-      fflush(stderr);
-    }
-  } else {
-    fmpz_poly_set(t_o, t_i);
-  }
-
   /* the precision of g_inv might not be sufficient to do this in one step, hence, we repeat until
      the result does not improve any more*/
 
@@ -240,7 +247,7 @@ void _fmpz_poly_oz_rem_small_iter(fmpz_poly_t rem, const fmpz_poly_t f, const fm
              oz_seconds(t));
       fflush(stderr);
     }
-  } while (mpfr_cmp(norm_o, norm_i) < 0);
+  } while (mpfr_cmp(norm_o, norm_i) < 0 && !oz_cancelled());
 
   fmpz_poly_set(rem, t_i);
   mpfr_clear(norm_i);
@@ -249,3 +256,53 @@ void _fmpz_poly_oz_rem_small_iter(fmpz_poly_t rem, const fmpz_poly_t f, const fm
   fmpz_poly_clear(t_i);
   fmpz_poly_clear(t_o);
 }
+
+void _fmpz_poly_oz_rem_small_iter(fmpz_poly_t rem,
+                                  const fmpz_poly_t f, const fmpz_poly_t g, const long n, const fmpq_poly_t ginv,
+                                  const mp_bitcnt_t b, const oz_flag_t flags) {
+
+  mp_bitcnt_t prec = (b) ? b : labs(_fmpz_vec_max_bits(ginv->coeffs, fmpq_poly_length(ginv)))/2;
+  fmpz_poly_t t_o;  fmpz_poly_init(t_o);
+
+  if (fmpz_poly_degree(f) == 0) {
+    uint64_t t = oz_walltime(0);
+    _fmpz_poly_oz_rem_small_fmpz_split(t_o, f->coeffs, g, n, ginv, prec);
+    t = oz_walltime(t);
+
+    if (flags & OZ_VERBOSE) {
+      fprintf(stderr, "|f|: %10.1f, |g|: %10.1f, |f%%g|: %10.1f, t: %10.6f\n",
+             fmpz_poly_2norm_log2(f), fmpz_poly_2norm_log2(g), fmpz_poly_2norm_log2(t_o),
+             oz_seconds(t));
+      fflush(stderr);
+    }
+  } else {
+    fmpz_poly_set(t_o, f);
+  }
+
+  _fmpz_poly_oz_rem_small_refine(rem, t_o, g, n, ginv, prec, flags);
+  fmpz_poly_clear(t_o);
+}
+
+void _fmpz_poly_oz_rem_small_iter_fmpz(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_oz_rem_small_ctx_t ctx,
+                                       const oz_flag_t flags) {
+  if (fmpz_is_zero(f)) {
+    fmpz_poly_zero(rem);
+    return;
+  }
+
+  fmpz_poly_t t_o;  fmpz_poly_init(t_o);
+
+  uint64_t t = oz_walltime(0);
+  _fmpz_poly_oz_rem_small_fmpz_split_ctx(t_o, f, ctx);
+  t = oz_walltime(t);
+
+  if (flags & OZ_VERBOSE) {
+    fprintf(stderr, "|f|: %10.1f, |g|: %10.1f, |f%%g|: %10.1f, t: %10.6f\n",
+            fmpz_sizeinbase(f, 2) * 1.0, fmpz_poly_2norm_log2(ctx->g), fmpz_poly_2norm_log2(t_o),
+            oz_seconds(t));
+    fflush(stderr);
+  }
+
+  _fmpz_poly_oz_rem_small_refine(rem, t_o, ctx->g, ctx->n, ctx->g_inv, ctx->b, flags);
+  fmpz_poly_clear(t_o);
+}
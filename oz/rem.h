@@ -50,6 +50,54 @@ void _fmpz_poly_oz_rem_small_fmpz(fmpz_poly_t rem, const fmpz_t f, const fmpz_po
 void _fmpz_poly_oz_rem_small_fmpz_split(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_t g,
                                         const long n, const fmpq_poly_t g_inv, const mp_bitcnt_t b);
 
+/**
+   @brief Precomputed data for reducing integers modulo $\\ideal{g}$.
+
+   Holds small representatives of $2^{(i+1)b} \\bmod \\ideal{g}$ for $0 ≤ i <$ `len`. Once
+   initialised a context is only read, so it may be shared between threads.
+*/
+
+typedef struct {
+  const fmpz_poly_struct *g;      //!< $g$, not owned
+  const fmpq_poly_struct *g_inv;  //!< approximate inverse of $g$, not owned
+  long n;                         //!< degree of cyclotomic polynomial
+  mp_bitcnt_t b;                  //!< chunk size in bits
+  mp_bitcnt_t rem_bound;          //!< log_2 of bound on the reduction of a $b$-bit chunk
+  size_t len;                     //!< number of chunks processed per round
+  fmpz_poly_struct *powb;         //!< powb[i] ~= $2^{(i+1)b} \\bmod \\ideal{g}$
+} fmpz_poly_oz_rem_small_ctx_struct;
+
+typedef fmpz_poly_oz_rem_small_ctx_struct fmpz_poly_oz_rem_small_ctx_t[1];
+
+/**
+   @brief Initialise reduction context for $g$.
+
+   @param ctx           context, return value
+   @param g             an element $g$ in $\\R$, must outlive `ctx`
+   @param n             degree of cyclotomic polynomial, must be power of two
+   @param g_inv         pre-computed approximate inverse of $g$ in $\\R$, must outlive `ctx`
+   @param b             process integers in chunks of size $b$ bits.
+ */
+
+void fmpz_poly_oz_rem_small_ctx_init(fmpz_poly_oz_rem_small_ctx_t ctx, const fmpz_poly_t g, const long n,
+                                     const fmpq_poly_t g_inv, const mp_bitcnt_t b);
+
+/**
+   @brief Clear reduction context.
+ */
+
+void fmpz_poly_oz_rem_small_ctx_clear(fmpz_poly_oz_rem_small_ctx_t ctx);
+
+/**
+   @brief Return a small representative of $f \\mod \\ideal{g}$ with $f \\in \\Z$ using `ctx`.
+
+   @param rem           return value, a small representative of $f \bmod \ideal{g}$.
+   @param f             an element $f$ in $\\Z$
+   @param ctx           initialised reduction context
+ */
+
+void _fmpz_poly_oz_rem_small_fmpz_split_ctx(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_oz_rem_small_ctx_t ctx);
+
 /**
    @brief Return a small representative of $f \\mod \\ideal{g}$.
 
@@ -77,4 +125,19 @@ void _fmpz_poly_oz_rem_small_iter(fmpz_poly_t rem,
                                   const fmpz_poly_t f, const fmpz_poly_t g, const long n, const fmpq_poly_t ginv,
                                   const mp_bitcnt_t b, const oz_flag_t flags);
 
+/**
+   @brief Return a small representative of $f \\mod \\ideal{g}$ with $f \\in \\Z$.
+
+   Same as `_fmpz_poly_oz_rem_small_iter()` for constant polynomials but the powers of $2^b$ are
+   taken from `ctx` instead of being recomputed.
+
+   @param rem           return value, a small representative of $f \bmod \ideal{g}$.
+   @param f             an element $f$ in $\\Z$
+   @param ctx           initialised reduction context
+   @param flags         flags controlling verbosity et al.
+ */
+
+void _fmpz_poly_oz_rem_small_iter_fmpz(fmpz_poly_t rem, const fmpz_t f, const fmpz_poly_oz_rem_small_ctx_t ctx,
+                                       const oz_flag_t flags);
+
 #endif /* _REM_H */
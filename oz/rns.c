@@ -0,0 +1,166 @@
+#include <assert.h>
+#include <omp.h>
+#include "rns.h"
+#include "norm.h"
+#include "util.h"
+
+void fmpz_oz_rns_init(fmpz_oz_rns_t rns, const size_t n, const mp_bitcnt_t bits) {
+  const mp_bitcnt_t pbits = FLINT_BITS - 2;
+  const size_t k = (bits + pbits - 2)/(pbits - 1);
+
+  rns->k = 0;
+  rns->p = _nmod_vec_init(k + 1);
+  fmpz_init_set_ui(rns->q, 1);
+
+  mp_limb_t p = (UWORD(1)<<pbits) + 1;
+  while(fmpz_sizeinbase(rns->q, 2) < bits) {
+    if (rns->k == k + 1)
+      oz_die("RNS basis for %lu bits requires more than %zu primes.", bits, k+1);
+    p = _n_prev_oz_good_probaprime(p, 2*n);
+    if (p == 0)
+      oz_die("Ran out of primes p ≡ 1 mod %zu.", 2*n);
+    rns->p[rns->k++] = p;
+    fmpz_mul_ui(rns->q, rns->q, p);
+  }
+
+  rns->mod = (nmod_t*)malloc(rns->k * sizeof(nmod_t));
+  for(size_t i=0; i<rns->k; i++)
+    nmod_init(rns->mod + i, rns->p[i]);
+
+  fmpz_comb_init(rns->comb, rns->p, rns->k);
+}
+
+void fmpz_oz_rns_clear(fmpz_oz_rns_t rns) {
+  fmpz_comb_clear(rns->comb);
+  free(rns->mod);
+  _nmod_vec_clear(rns->p);
+  fmpz_clear(rns->q);
+  rns->k = 0;
+}
+
+void fmpz_oz_rns_root(fmpz_t phi, const fmpz_oz_rns_t rns, const size_t n) {
+  mp_ptr phi_ = _nmod_vec_init(rns->k);
+  for(size_t i=0; i<rns->k; i++)
+    phi_[i] = _nmod_nth_root(2*n, rns->p[i]);
+
+  fmpz_comb_temp_t comb_temp;
+  fmpz_comb_temp_init(comb_temp, rns->comb);
+  fmpz_multi_CRT_ui(phi, phi_, rns->comb, comb_temp, 0);
+  fmpz_comb_temp_clear(comb_temp);
+
+  _nmod_vec_clear(phi_);
+}
+
+void fmpz_mod_poly_oz_rns_init(fmpz_mod_poly_oz_rns_t op, const size_t n, const fmpz_oz_rns_t rns) {
+  op->n = n;
+  op->k = rns->k;
+  op->coeffs = _nmod_vec_init(n * rns->k);
+  _nmod_vec_zero(op->coeffs, n * rns->k);
+}
+
+void fmpz_mod_poly_oz_rns_clear(fmpz_mod_poly_oz_rns_t op) {
+  _nmod_vec_clear(op->coeffs);
+  op->coeffs = NULL;
+}
+
+void fmpz_mod_poly_oz_rns_set(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_oz_rns_t op) {
+  assert((rop->n == op->n) && (rop->k == op->k));
+  if (rop == op)
+    return;
+  _nmod_vec_set(rop->coeffs, op->coeffs, op->n * op->k);
+}
+
+void fmpz_mod_poly_oz_rns_set_fmpz_mod_poly(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_t op, const fmpz_oz_rns_t rns) {
+  const size_t n = rop->n;
+  const size_t k = rns->k;
+  assert(rop->k == k);
+
+  const int num_threads = omp_get_max_threads();
+  fmpz_comb_temp_struct comb_temp[num_threads];
+  mp_ptr r[num_threads];
+  for(int t=0; t<num_threads; t++) {
+    fmpz_comb_temp_init(comb_temp + t, rns->comb);
+    r[t] = _nmod_vec_init(k);
+  }
+
+#pragma omp parallel for
+  for(size_t j=0; j<n; j++) {
+    const int id = omp_get_thread_num();
+    if (j < (size_t)op->length) {
+      fmpz_multi_mod_ui(r[id], op->coeffs + j, rns->comb, comb_temp + id);
+      for(size_t i=0; i<k; i++)
+        rop->coeffs[i*n + j] = r[id][i];
+    } else {
+      for(size_t i=0; i<k; i++)
+        rop->coeffs[i*n + j] = 0;
+    }
+  }
+
+  for(int t=0; t<num_threads; t++) {
+    _nmod_vec_clear(r[t]);
+    fmpz_comb_temp_clear(comb_temp + t);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_rns_t op, const fmpz_oz_rns_t rns) {
+  const size_t n = op->n;
+  const size_t k = rns->k;
+  assert(op->k == k);
+  assert(fmpz_equal(fmpz_mod_poly_modulus(rop), rns->q));
+
+  fmpz_mod_poly_fit_length(rop, n);
+
+  const int num_threads = omp_get_max_threads();
+  fmpz_comb_temp_struct comb_temp[num_threads];
+  mp_ptr r[num_threads];
+  for(int t=0; t<num_threads; t++) {
+    fmpz_comb_temp_init(comb_temp + t, rns->comb);
+    r[t] = _nmod_vec_init(k);
+  }
+
+#pragma omp parallel for
+  for(size_t j=0; j<n; j++) {
+    const int id = omp_get_thread_num();
+    for(size_t i=0; i<k; i++)
+      r[id][i] = op->coeffs[i*n + j];
+    fmpz_multi_CRT_ui(rop->coeffs + j, r[id], rns->comb, comb_temp + id, 0);
+  }
+
+  _fmpz_mod_poly_set_length(rop, n);
+  _fmpz_mod_poly_normalise(rop);
+
+  for(int t=0; t<num_threads; t++) {
+    _nmod_vec_clear(r[t]);
+    fmpz_comb_temp_clear(comb_temp + t);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_add(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g, const fmpz_oz_rns_t rns) {
+  const size_t n = h->n;
+  assert((f->n == n) && (g->n == n));
+
+#pragma omp parallel for
+  for(size_t i=0; i<rns->k; i++)
+    _nmod_vec_add(h->coeffs + i*n, f->coeffs + i*n, g->coeffs + i*n, n, rns->mod[i]);
+}
+
+void fmpz_mod_poly_oz_rns_sub(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g, const fmpz_oz_rns_t rns) {
+  const size_t n = h->n;
+  assert((f->n == n) && (g->n == n));
+
+#pragma omp parallel for
+  for(size_t i=0; i<rns->k; i++)
+    _nmod_vec_sub(h->coeffs + i*n, f->coeffs + i*n, g->coeffs + i*n, n, rns->mod[i]);
+}
+
+void fmpz_mod_poly_oz_rns_mul(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g, const fmpz_oz_rns_t rns) {
+  const size_t n = h->n;
+  const size_t k = rns->k;
+  assert((f->n == n) && (g->n == n));
+
+#pragma omp parallel for
+  for(size_t l=0; l<k*n; l++) {
+    const nmod_t mod = rns->mod[l/n];
+    h->coeffs[l] = n_mulmod2_preinv(f->coeffs[l], g->coeffs[l], mod.n, mod.ninv);
+  }
+}
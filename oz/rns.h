@@ -0,0 +1,129 @@
+/**
+   @file rns.h
+   @brief Residue number system (RNS) representation of elements in the NTT domain.
+
+   Let @f$q = \prod_{i=0}^{k-1} p_i@f$ where each $p_i$ is a word-sized prime with $p_i ≡ 1 \\bmod
+   2n$. Then @f$\ZZ_q ≅ \prod \ZZ_{p_i}@f$ and, since a primitive $2n$-th root of unity modulo $q$
+   reduces to a primitive $2n$-th root of unity modulo each $p_i$, reducing each slot of an element
+   in the NTT domain modulo $p_i$ produces its NTT domain representation modulo $p_i$. Hence, ring
+   addition, subtraction and multiplication can be performed on word-sized residues independently
+   for each $p_i$ and we only need to reconstruct the representation modulo $q$ via the CRT when
+   this is required, e.g. for zero-testing.
+*/
+
+#ifndef _RNS_H_
+#define _RNS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <flint/fmpz.h>
+#include <flint/nmod_vec.h>
+#include <flint/fmpz_mod_poly.h>
+
+/**
+   @brief A set of word-sized NTT-friendly primes.
+*/
+
+struct fmpz_oz_rns_struct {
+  size_t k;           //!< number of primes $k$
+  mp_ptr p;           //!< primes $p_i ≡ 1 \\bmod 2n$
+  nmod_t *mod;        //!< pre-computed data for computing modulo $p_i$
+  fmpz_t q;           //!< product @f$q = \prod p_i@f$
+  fmpz_comb_t comb;   //!< pre-computed data for the CRT
+};
+
+/**
+   @brief A set of word-sized NTT-friendly primes.
+*/
+
+typedef struct fmpz_oz_rns_struct fmpz_oz_rns_t[1];
+
+/**
+   @brief Pick primes $p_i ≡ 1 \\bmod 2n$ such that @f$\prod p_i@f$ has at least `bits` bits.
+
+   @param rns           uninitialised RNS basis
+   @param n             dimension, must be a power of two
+   @param bits          minimal bit size of $q$
+*/
+
+void fmpz_oz_rns_init(fmpz_oz_rns_t rns, const size_t n, const mp_bitcnt_t bits);
+
+/**
+   @brief Clear RNS basis.
+*/
+
+void fmpz_oz_rns_clear(fmpz_oz_rns_t rns);
+
+/**
+   @brief Set $φ$ to a primitive $2n$-th root of unity modulo $q = \\prod p_i$.
+
+   @note The output is suitable as input to `_fmpz_mod_poly_oz_ntt_precomp_init`.
+*/
+
+void fmpz_oz_rns_root(fmpz_t phi, const fmpz_oz_rns_t rns, const size_t n);
+
+/**
+   @brief An element in the NTT domain in RNS representation.
+*/
+
+struct fmpz_mod_poly_oz_rns_struct {
+  size_t n;           //!< number of slots $n$
+  size_t k;           //!< number of primes $k$
+  mp_ptr coeffs;      //!< slot $j$ modulo $p_i$ is stored at index $i·n + j$
+};
+
+/**
+   @brief An element in the NTT domain in RNS representation.
+*/
+
+typedef struct fmpz_mod_poly_oz_rns_struct fmpz_mod_poly_oz_rns_t[1];
+
+/**
+   @brief Initialise `op` to zero.
+*/
+
+void fmpz_mod_poly_oz_rns_init(fmpz_mod_poly_oz_rns_t op, const size_t n, const fmpz_oz_rns_t rns);
+
+/**
+   @brief Clear `op`.
+*/
+
+void fmpz_mod_poly_oz_rns_clear(fmpz_mod_poly_oz_rns_t op);
+
+/**
+   @brief Set $\\mbox{rop} = \\mbox{op}$.
+*/
+
+void fmpz_mod_poly_oz_rns_set(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_oz_rns_t op);
+
+/**
+   @brief Set `rop` to the RNS representation of `op`, which must be in the NTT domain modulo $q = \\prod p_i$.
+*/
+
+void fmpz_mod_poly_oz_rns_set_fmpz_mod_poly(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_t op, const fmpz_oz_rns_t rns);
+
+/**
+   @brief Reconstruct `rop` modulo $q = \\prod p_i$ from `op` using the CRT.
+*/
+
+void fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_rns_t op, const fmpz_oz_rns_t rns);
+
+/**
+   @brief Compute $h = f + g$.
+*/
+
+void fmpz_mod_poly_oz_rns_add(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g, const fmpz_oz_rns_t rns);
+
+/**
+   @brief Compute $h = f - g$.
+*/
+
+void fmpz_mod_poly_oz_rns_sub(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g, const fmpz_oz_rns_t rns);
+
+/**
+   @brief Compute $h = f · g$.
+*/
+
+void fmpz_mod_poly_oz_rns_mul(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g, const fmpz_oz_rns_t rns);
+
+#endif /* _RNS_H_ */
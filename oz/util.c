@@ -1 +1,3 @@
 #include "util.h"
+
+__thread const int *oz_cancel_flag = NULL;
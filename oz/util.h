@@ -30,4 +30,15 @@ static inline double oz_seconds(uint64_t t) {
   return t/1000000.0;
 }
 
+/**
+   Cancellation flag of the calling thread. Long running loops return early, with a result that must
+   be discarded, once it points to a non-zero value.
+*/
+
+extern __thread const int *oz_cancel_flag;
+
+static inline int oz_cancelled(void) {
+  return oz_cancel_flag != NULL && __atomic_load_n(oz_cancel_flag, __ATOMIC_ACQUIRE);
+}
+
 #endif /* _UTIL_H_ */
@@ -0,0 +1,145 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+/* compare element i of op with f, products in the NTT domain are not normalised */
+
+static int _arena_equal(const gghlite_params_t self, const gghlite_enc_arena_t op, const size_t i, const gghlite_enc_t f) {
+    gghlite_enc_t t, g;
+    gghlite_enc_init(t, self);
+    gghlite_enc_init(g, self);
+    gghlite_enc_set_gghlite_enc_arena(t, op, i);
+    gghlite_enc_set(g, f);
+    _fmpz_mod_poly_normalise(g);
+    int r = fmpz_mod_poly_equal(t, g);
+    gghlite_enc_clear(g);
+    gghlite_enc_clear(t);
+    return r;
+}
+
+int test_arena(const size_t lambda, const oz_flag_t flags, aes_randstate_t randstate) {
+    printf("λ: %4zu, huge pages: %d, arena …", lambda, (flags & OZ_HUGEPAGES) != 0);
+
+    const size_t kappa = 2;
+    gghlite_sk_t self;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV, randstate);
+
+    int group[kappa];
+    memset(group, 0, kappa * sizeof(int));
+    group[0] = 1;
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    fmpz_t a, b, ab;
+    fmpz_init(a);
+    fmpz_init(b);
+    fmpz_init(ab);
+    fmpz_randm_aes(a, randstate, p);
+    fmpz_randm_aes(b, randstate, p);
+    fmpz_mul(ab, a, b);
+    fmpz_mod(ab, ab, p);
+
+    gghlite_clr_t e; gghlite_clr_init(e);
+    gghlite_enc_t u, v, w, t;
+    gghlite_enc_init(u, self->params);
+    gghlite_enc_init(v, self->params);
+    gghlite_enc_init(w, self->params);
+    gghlite_enc_init(t, self->params);
+
+    fmpz_poly_set_coeff_fmpz(e, 0, a);
+    gghlite_enc_set_gghlite_clr(u, self, e, 1, group, 0);
+    fmpz_poly_set_coeff_fmpz(e, 0, b);
+    gghlite_enc_set_gghlite_clr(v, self, e, 1, group, 0);
+    fmpz_poly_set_coeff_fmpz(e, 0, ab);
+    gghlite_enc_set_gghlite_clr(w, self, e, kappa, group, 0);
+
+    gghlite_enc_arena_t arena;
+    gghlite_enc_arena_init(arena, self->params, 6, flags);
+    gghlite_enc_arena_set_gghlite_enc(arena, 0, u);
+    gghlite_enc_arena_set_gghlite_enc(arena, 1, v);
+    gghlite_enc_arena_set_gghlite_enc(arena, 2, w);
+
+    int status = 0;
+
+    /* arithmetic on limbs agrees with arithmetic on fmpz_mod_poly */
+    gghlite_enc_arena_add(arena, 3, 0, 1);
+    gghlite_enc_add(t, self->params, u, v);
+    status += !_arena_equal(self->params, arena, 3, t);
+
+    gghlite_enc_arena_sub(arena, 3, 0, 1);
+    gghlite_enc_sub(t, self->params, u, v);
+    status += !_arena_equal(self->params, arena, 3, t);
+
+    gghlite_enc_arena_sub(arena, 3, 1, 0);
+    gghlite_enc_sub(t, self->params, v, u);
+    status += !_arena_equal(self->params, arena, 3, t);
+
+    gghlite_enc_arena_mul(arena, 3, 0, 1);
+    gghlite_enc_mul(t, self->params, u, v);
+    status += !_arena_equal(self->params, arena, 3, t);
+
+    /* aliased */
+    fmpz_mod_poly_oz_arena_set(arena, 4, 0);
+    gghlite_enc_arena_mul(arena, 4, 4, 1);
+    status += !_arena_equal(self->params, arena, 4, t);
+
+    fmpz_mod_poly_oz_arena_set(arena, 4, 1);
+    gghlite_enc_arena_add(arena, 4, 4, 4);
+    gghlite_enc_add(t, self->params, v, v);
+    status += !_arena_equal(self->params, arena, 4, t);
+
+    /* enc(a)·enc(b) - enc(a·b) is an encoding of zero, enc(a)·enc(b) + enc(a·b) is not */
+    gghlite_enc_mul(t, self->params, u, v);
+    gghlite_enc_sub(t, self->params, t, w);
+    gghlite_enc_arena_mul(arena, 4, 0, 1);
+    gghlite_enc_arena_sub(arena, 4, 4, 2);
+    status += !_arena_equal(self->params, arena, 4, t);
+    status += 1 - gghlite_enc_is_zero(self->params, t);
+    status += 1 - gghlite_enc_arena_is_zero(self->params, arena, 4);
+
+    gghlite_enc_mul(t, self->params, u, v);
+    gghlite_enc_add(t, self->params, t, w);
+    gghlite_enc_arena_mul(arena, 5, 0, 1);
+    gghlite_enc_arena_add(arena, 5, 5, 2);
+    status += !_arena_equal(self->params, arena, 5, t);
+    status += gghlite_enc_is_zero(self->params, t);
+    status += gghlite_enc_arena_is_zero(self->params, arena, 5);
+
+    /* x - x is zero in every slot */
+    gghlite_enc_arena_sub(arena, 5, 2, 2);
+    status += 1 - fmpz_mod_poly_oz_arena_is_zero(arena, 5);
+    status += fmpz_mod_poly_oz_arena_is_zero(arena, 2);
+
+    gghlite_enc_arena_clear(arena);
+    gghlite_enc_clear(u);
+    gghlite_enc_clear(v);
+    gghlite_enc_clear(w);
+    gghlite_enc_clear(t);
+    gghlite_clr_clear(e);
+    fmpz_clear(a);
+    fmpz_clear(b);
+    fmpz_clear(ab);
+    fmpz_clear(p);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_arena(20, 0, randstate);
+    status += test_arena(20, OZ_HUGEPAGES, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -0,0 +1,98 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+int test_async(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu …", lambda, kappa);
+
+    int status = 0;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV;
+
+    gghlite_sk_t self;
+    gghlite_future_t fut;
+    gghlite_init_async(fut, self, lambda, kappa, kappa, 0x0, flags, randstate);
+    if (gghlite_future_poll(fut) == GGHLITE_FUTURE_CANCELLED)
+        status++;
+    if (gghlite_future_wait(fut, 0) != GGHLITE_FUTURE_DONE)
+        status++;
+    gghlite_future_clear(fut);
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    int group[kappa];
+    memset(group, 0, kappa * sizeof(int));
+    group[0] = 1;
+
+    gghlite_clr_t e; gghlite_clr_init(e);
+    fmpz_t a; fmpz_init(a);
+    fmpz_randm_aes(a, randstate, p);
+    fmpz_poly_set_coeff_fmpz(e, 0, a);
+
+    gghlite_enc_t u, v;
+    gghlite_enc_init(u, self->params);
+    gghlite_enc_init(v, self->params);
+
+    /* encode on another thread, zero-test the difference on yet another */
+    gghlite_enc_set_gghlite_clr_async(fut, u, self, e, kappa, group, 1);
+    if (gghlite_future_wait(fut, 0) != GGHLITE_FUTURE_DONE)
+        status++;
+    gghlite_future_clear(fut);
+
+    gghlite_enc_set_gghlite_clr(v, self, e, kappa, group, 1);
+    gghlite_enc_sub(v, self->params, v, u);
+    gghlite_enc_is_zero_async(fut, self->params, v);
+    status += 1 - gghlite_future_result(fut);
+    gghlite_future_clear(fut);
+
+    gghlite_enc_add(v, self->params, u, u);
+    gghlite_enc_is_zero_async(fut, self->params, v);
+    status += gghlite_future_result(fut);
+    gghlite_future_clear(fut);
+
+    gghlite_enc_clear(u);
+    gghlite_enc_clear(v);
+    gghlite_clr_clear(e);
+    fmpz_clear(a);
+    fmpz_clear(p);
+    gghlite_sk_clear(self, 1);
+
+    /* a large instance is still running after 1ms, cancelling it clears the secret key */
+    gghlite_sk_t large;
+    gghlite_init_async(fut, large, 4*lambda, kappa, kappa, 0x0, flags, randstate);
+    if (gghlite_future_wait(fut, 1000) != GGHLITE_FUTURE_PENDING)
+        status++;
+    gghlite_future_cancel(fut);
+    switch(gghlite_future_wait(fut, 0)) {
+    case GGHLITE_FUTURE_CANCELLED:
+        break;
+    case GGHLITE_FUTURE_DONE:
+        gghlite_sk_clear(large, 1);
+        status++;
+        break;
+    default:
+        status++;
+    }
+    gghlite_future_clear(fut);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_async(20, 2, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
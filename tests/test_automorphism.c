@@ -0,0 +1,266 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+/* rop = op(x^k) mod x^n+1 in the coefficient domain */
+
+static void _automorphism_ref(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const long k, const size_t n) {
+  const long m = (long)(2*n);
+  const size_t k_ = (size_t)(((k % m) + m) % m);
+  fmpz_t t; fmpz_init(t);
+  fmpz_mod_poly_zero(rop);
+  for(size_t i=0; i<(size_t)op->length; i++) {
+    const size_t e = (i * k_) % (2*n);
+    if (e < n) {
+      fmpz_mod_poly_set_coeff_fmpz(rop, e, op->coeffs + i);
+    } else {
+      fmpz_sub(t, &op->p, op->coeffs + i);
+      fmpz_mod(t, t, &op->p);
+      fmpz_mod_poly_set_coeff_fmpz(rop, e - n, t);
+    }
+  }
+  fmpz_clear(t);
+}
+
+/* fmpz_poly_oz_conjugate as it was before it wrote coefficients directly */
+
+static void _fmpz_poly_oz_conjugate_ref(fmpz_poly_t fT, const fmpz_poly_t f, const long n) {
+  fmpz_poly_zero(fT);
+  fmpz_t t0; fmpz_init(t0);
+  fmpz_t t1; fmpz_init(t1);
+
+  fmpz_poly_get_coeff_fmpz(t0, f, 0);
+  fmpz_poly_set_coeff_fmpz(fT, 0, t0);
+
+  for(int i=1; i<n/2; i++) {
+    fmpz_poly_get_coeff_fmpz(t0, f,   i);
+    fmpz_poly_get_coeff_fmpz(t1, f, n-i);
+    fmpz_neg(t0, t0);
+    fmpz_neg(t1, t1);
+    fmpz_poly_set_coeff_fmpz(fT, n-i, t0);
+    fmpz_poly_set_coeff_fmpz(fT, i, t1);
+  }
+  fmpz_poly_get_coeff_fmpz(t0, f, n/2);
+  fmpz_neg(t0, t0);
+  fmpz_poly_set_coeff_fmpz(fT, n/2, t0);
+
+  fmpz_clear(t1);
+  fmpz_clear(t0);
+}
+
+/* NTT decoding leaves the length at n */
+
+static void _dec(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  fmpz_mod_poly_oz_ntt_dec(rop, op, precomp);
+  _fmpz_mod_poly_normalise(rop);
+}
+
+static void _randm(fmpz_mod_poly_t f, const size_t len, aes_randstate_t randstate) {
+  fmpz_t c; fmpz_init(c);
+  fmpz_mod_poly_zero(f);
+  for(size_t i=0; i<len; i++) {
+    fmpz_randm_aes(c, randstate, &f->p);
+    fmpz_mod_poly_set_coeff_fmpz(f, i, c);
+  }
+  fmpz_clear(c);
+}
+
+int test_ntt_automorphism(const size_t n, const mp_bitcnt_t bits, aes_randstate_t randstate) {
+  printf("n: %5zu, log(q): %4lu, automorphism …", n, bits);
+
+  /* q ≡ 1 mod 2n */
+  fmpz_t q; fmpz_init(q);
+  fmpz_one(q);
+  fmpz_mul_2exp(q, q, bits);
+  fmpz_add_ui(q, q, 1);
+  while (!fmpz_is_probabprime(q))
+    fmpz_add_ui(q, q, 2*n);
+
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
+
+  fmpz_mod_poly_t f, g, h, r;
+  fmpz_mod_poly_init(f, q);
+  fmpz_mod_poly_init(g, q);
+  fmpz_mod_poly_init(h, q);
+  fmpz_mod_poly_init(r, q);
+
+  int status = 0;
+
+  const long k[] = {1, 3, 5, 7, (long)n+1, (long)(2*n)-1, -1, -3, 0};
+
+  for(size_t l=0; k[l]; l++) {
+    /* full and short inputs, the latter leave slots beyond the length implicit */
+    const size_t len[] = {n, n/2 - 1};
+    for(size_t j=0; j<2; j++) {
+      _randm(f, len[j], randstate);
+      _automorphism_ref(r, f, k[l], n);
+
+      fmpz_mod_poly_oz_ntt_enc(g, f, precomp);
+
+      _fmpz_mod_poly_oz_ntt_automorphism(h, g, k[l], precomp);
+      _dec(h, h, precomp);
+      status += !fmpz_mod_poly_equal(h, r);
+
+      /* aliased */
+      _fmpz_mod_poly_oz_ntt_automorphism(g, g, k[l], precomp);
+      _dec(g, g, precomp);
+      status += !fmpz_mod_poly_equal(g, r);
+
+      /* conjugation is x ↦ x^{2n-1} */
+      if (k[l] == -1) {
+        fmpz_mod_poly_oz_ntt_enc(g, f, precomp);
+        fmpz_mod_poly_oz_ntt_conjugate(h, g, n);
+        _dec(h, h, precomp);
+        status += !fmpz_mod_poly_equal(h, r);
+
+        fmpz_mod_poly_oz_ntt_conjugate(g, g, n);
+        _dec(g, g, precomp);
+        status += !fmpz_mod_poly_equal(g, r);
+      }
+    }
+  }
+
+  fmpz_mod_poly_clear(f);
+  fmpz_mod_poly_clear(g);
+  fmpz_mod_poly_clear(h);
+  fmpz_mod_poly_clear(r);
+  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_clear(q);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+int test_fmpz_poly_oz_conjugate(const long n, aes_randstate_t randstate) {
+  printf("n: %5ld, fmpz_poly_oz_conjugate …", n);
+
+  fmpz_t B; fmpz_init(B);
+  fmpz_set_ui(B, 1);
+  fmpz_mul_2exp(B, B, 64);
+
+  fmpz_t c; fmpz_init(c);
+  fmpz_poly_t f, g, r;
+  fmpz_poly_init(f);
+  fmpz_poly_init(g);
+  fmpz_poly_init(r);
+
+  int status = 0;
+
+  const long len[] = {n, n-1, n/2 + 1, n/2, 1, 0};
+  for(size_t l=0; l<sizeof(len)/sizeof(len[0]); l++) {
+    fmpz_poly_zero(f);
+    for(long i=0; i<len[l]; i++) {
+      fmpz_randm_aes(c, randstate, B);
+      fmpz_sub_ui(c, c, 1UL<<63);
+      fmpz_poly_set_coeff_fmpz(f, i, c);
+    }
+
+    _fmpz_poly_oz_conjugate_ref(r, f, n);
+    fmpz_poly_oz_conjugate(g, f, n);
+    status += !fmpz_poly_equal(g, r);
+
+    /* aliased */
+    fmpz_poly_oz_conjugate(f, f, n);
+    status += !fmpz_poly_equal(f, r);
+  }
+
+  fmpz_poly_clear(f);
+  fmpz_poly_clear(g);
+  fmpz_poly_clear(r);
+  fmpz_clear(c);
+  fmpz_clear(B);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+int test_enc_automorphism(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+  printf("λ: %4zu, κ: %2zu, gghlite_enc_automorphism …", lambda, kappa);
+
+  gghlite_sk_t self;
+  gghlite_init(self, lambda, kappa, kappa, 0x0, GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV, randstate);
+  const size_t n = self->params->n;
+
+  int group[kappa];
+  memset(group, 0, kappa * sizeof(int));
+  group[0] = 1;
+
+  fmpz_t B; fmpz_init_set_ui(B, 256);
+  fmpz_t c; fmpz_init(c);
+  gghlite_clr_t e; gghlite_clr_init(e);
+  for(size_t i=0; i<n; i++) {
+    fmpz_randm_aes(c, randstate, B);
+    fmpz_poly_set_coeff_fmpz(e, i, c);
+  }
+
+  gghlite_enc_t u, v;
+  gghlite_enc_init(u, self->params);
+  gghlite_enc_init(v, self->params);
+  fmpz_mod_poly_t f, r;
+  fmpz_mod_poly_init(f, self->params->q);
+  fmpz_mod_poly_init(r, self->params->q);
+
+  gghlite_enc_set_gghlite_clr(u, self, e, 1, group, 0);
+  _dec(f, u, self->params->ntt);
+
+  int status = 0;
+
+  const long k[] = {3, (long)n+1, (long)(2*n)-1, 0};
+  for(size_t l=0; k[l]; l++) {
+    _automorphism_ref(r, f, k[l], n);
+    gghlite_enc_automorphism(v, self->params, u, k[l]);
+    _dec(v, v, self->params->ntt);
+    status += !fmpz_mod_poly_equal(v, r);
+  }
+
+  /* conjugation */
+  _automorphism_ref(r, f, -1, n);
+  gghlite_enc_conjugate(v, self->params, u);
+  _dec(v, v, self->params->ntt);
+  status += !fmpz_mod_poly_equal(v, r);
+
+  /* conjugating twice is the identity */
+  gghlite_enc_conjugate(v, self->params, u);
+  gghlite_enc_conjugate(v, self->params, v);
+  _dec(v, v, self->params->ntt);
+  status += !fmpz_mod_poly_equal(v, f);
+
+  fmpz_mod_poly_clear(f);
+  fmpz_mod_poly_clear(r);
+  gghlite_enc_clear(u);
+  gghlite_enc_clear(v);
+  gghlite_clr_clear(e);
+  fmpz_clear(c);
+  fmpz_clear(B);
+  gghlite_sk_clear(self, 1);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+int main(int argc, char *argv[]) {
+  aes_randstate_t randstate;
+  aes_randinit(randstate);
+
+  int status = 0;
+
+  status += test_ntt_automorphism(16, 40, randstate);
+  status += test_ntt_automorphism(1024, 80, randstate);
+  status += test_fmpz_poly_oz_conjugate(16, randstate);
+  status += test_fmpz_poly_oz_conjugate(1024, randstate);
+  status += test_enc_automorphism(20, 2, randstate);
+
+  aes_randclear(randstate);
+  flint_cleanup();
+  mpfr_free_cache();
+  return status;
+}
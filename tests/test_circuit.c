@@ -0,0 +1,127 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+int test_circuit(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu …", lambda, kappa);
+
+    gghlite_sk_t self;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, flags, randstate);
+
+    int status = 0;
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    const size_t len = 2*kappa;
+    gghlite_clr_t e[len];
+    gghlite_enc_t u[len];
+
+    int group[kappa];
+    memset(group, 0, kappa * sizeof(int));
+    group[0] = 1;
+
+    fmpz_t a; fmpz_init(a);
+    for(size_t i=0; i<len; i++) {
+        gghlite_clr_init(e[i]);
+        fmpz_randm_aes(a, randstate, p);
+        fmpz_poly_set_coeff_fmpz(e[i], 0, a);
+        gghlite_enc_init(u[i], self->params);
+        gghlite_enc_set_gghlite_clr(u[i], self, e[i], 1, group, 1);
+    }
+
+    /* x = ∏ u[0:κ] + ∏ u[κ:2κ], y = x - ∏ u[0:κ] - ∏ u[κ:2κ] */
+    gghlite_circuit_t circuit;
+    gghlite_circuit_init(circuit, self->params);
+
+    size_t in[len];
+    for(size_t i=0; i<len; i++)
+        in[i] = gghlite_circuit_input(circuit, 1, group);
+
+    size_t l0 = in[0], r0 = in[0], l1 = in[kappa], r1 = in[kappa];
+    for(size_t k=1; k<kappa; k++) {
+        l0 = gghlite_circuit_mul(circuit, l0, in[k]);
+        r0 = gghlite_circuit_mul(circuit, r0, in[k]);
+        l1 = gghlite_circuit_mul(circuit, l1, in[kappa + k]);
+        r1 = gghlite_circuit_mul(circuit, r1, in[kappa + k]);
+    }
+    const size_t x = gghlite_circuit_add(circuit, l0, l1);
+    const size_t y = gghlite_circuit_sub(circuit, gghlite_circuit_sub(circuit, x, r0), r1);
+
+    gghlite_circuit_output(circuit, x);
+    gghlite_circuit_is_zero(circuit, x);
+    gghlite_circuit_is_zero(circuit, y);
+
+    if (gghlite_circuit_compile(circuit) != 0)
+        status++;
+
+    /* the sums are fused into inner products */
+    if (!circuit->nodes[x].nterms || !circuit->nodes[y].nterms)
+        status++;
+
+    gghlite_enc_t out[1];
+    gghlite_enc_init(out[0], self->params);
+    int is_zero[2] = {-1, -1};
+
+    if (gghlite_circuit_eval(out, is_zero, circuit, u) != 0)
+        status++;
+
+    status += is_zero[0];
+    status += 1 - is_zero[1];
+
+    /* evaluating by hand gives the same encoding */
+    gghlite_enc_t l, r;
+    gghlite_enc_init(l, self->params);
+    gghlite_enc_init(r, self->params);
+    gghlite_enc_set(l, u[0]);
+    gghlite_enc_set(r, u[kappa]);
+    for(size_t k=1; k<kappa; k++) {
+        gghlite_enc_mul(l, self->params, l, u[k]);
+        gghlite_enc_mul(r, self->params, r, u[kappa + k]);
+    }
+    gghlite_enc_add(l, self->params, l, r);
+    if (!fmpz_mod_poly_equal(l, out[0]))
+        status++;
+
+    /* adding encodings at different levels is rejected */
+    gghlite_circuit_add(circuit, in[0], l0);
+    if (gghlite_circuit_compile(circuit) == 0 || circuit->error != circuit->len - 1)
+        status++;
+
+    gghlite_circuit_clear(circuit);
+
+    for(size_t i=0; i<len; i++) {
+        gghlite_clr_clear(e[i]);
+        gghlite_enc_clear(u[i]);
+    }
+    gghlite_enc_clear(out[0]);
+    gghlite_enc_clear(l);
+    gghlite_enc_clear(r);
+    fmpz_clear(a);
+    fmpz_clear(p);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_circuit(20, 2, randstate);
+    status += test_circuit(20, 3, randstate);
+    status += test_circuit(20, 4, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
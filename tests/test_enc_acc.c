@@ -0,0 +1,105 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+/* compare op with f after converting it back */
+
+static int _acc_equal(const gghlite_params_t self, const gghlite_enc_acc_t op, const gghlite_enc_t f) {
+    gghlite_enc_t t;
+    gghlite_enc_init(t, self);
+    gghlite_enc_set_gghlite_enc_acc(t, self, op);
+    int r = fmpz_mod_poly_equal(t, f) && (op->bound <= GGHLITE_ENC_ACC_MAX_BOUND);
+    gghlite_enc_clear(t);
+    return r;
+}
+
+int test_enc_acc(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+    printf("λ: %4zu, κ: %2zu, accumulator …", lambda, kappa);
+
+    gghlite_sk_t self;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV, randstate);
+
+    int group[kappa];
+    memset(group, 0, kappa * sizeof(int));
+    group[0] = 1;
+
+    fmpz_t c; fmpz_init(c);
+    gghlite_clr_t e; gghlite_clr_init(e);
+    gghlite_enc_t u, v, r, s;
+    gghlite_enc_init(u, self->params);
+    gghlite_enc_init(v, self->params);
+    gghlite_enc_init(r, self->params);
+    gghlite_enc_init(s, self->params);
+
+    fmpz_set_ui(c, 2);
+    fmpz_poly_set_coeff_fmpz(e, 0, c);
+    gghlite_enc_set_gghlite_clr(u, self, e, 1, group, 0);
+    fmpz_set_ui(c, 3);
+    fmpz_poly_set_coeff_fmpz(e, 0, c);
+    gghlite_enc_set_gghlite_clr(v, self, e, 1, group, 0);
+
+    gghlite_enc_acc_t f, h;
+    gghlite_enc_acc_init(f, self->params);
+    gghlite_enc_acc_init(h, self->params);
+
+    int status = 0;
+
+    /* f = u + … + u up to the maximum bound, r the same using gghlite_enc_add */
+    gghlite_enc_acc_set_gghlite_enc(f, self->params, u);
+    gghlite_enc_set(r, u);
+    for(size_t i=1; i<GGHLITE_ENC_ACC_MAX_BOUND; i++) {
+        gghlite_enc_acc_add(f, self->params, u);
+        gghlite_enc_add(r, self->params, r, u);
+    }
+    status += (f->bound != GGHLITE_ENC_ACC_MAX_BOUND);
+    status += !_acc_equal(self->params, f, r);
+
+    /* h = v + f, where f alone is at the maximum bound */
+    gghlite_enc_acc_set_gghlite_enc(h, self->params, v);
+    gghlite_enc_acc_add_acc(h, self->params, f);
+    gghlite_enc_add(s, self->params, v, r);
+    status += !_acc_equal(self->params, h, s);
+
+    /* h = h + f, where h was just reduced */
+    gghlite_enc_acc_add_acc(h, self->params, f);
+    gghlite_enc_add(s, self->params, s, r);
+    status += !_acc_equal(self->params, h, s);
+
+    /* and past the maximum bound */
+    for(size_t i=0; i<3; i++) {
+        gghlite_enc_acc_add(f, self->params, u);
+        gghlite_enc_acc_sub(f, self->params, v);
+        gghlite_enc_add(r, self->params, r, u);
+        gghlite_enc_sub(r, self->params, r, v);
+    }
+    status += !_acc_equal(self->params, f, r);
+
+    gghlite_enc_acc_clear(f);
+    gghlite_enc_acc_clear(h);
+    gghlite_enc_clear(u);
+    gghlite_enc_clear(v);
+    gghlite_enc_clear(r);
+    gghlite_enc_clear(s);
+    gghlite_clr_clear(e);
+    fmpz_clear(c);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_enc_acc(20, 2, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
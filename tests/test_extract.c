@@ -0,0 +1,126 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+int test_extract(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu …", lambda, kappa);
+
+    gghlite_sk_t self;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, flags, randstate);
+
+    int status = 0;
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    fmpz_t a[kappa];
+    fmpz_t acc;  fmpz_init(acc);
+    fmpz_set_ui(acc, 1);
+
+    for(size_t k=0; k<kappa; k++) {
+        fmpz_init(a[k]);
+        fmpz_randm_aes(a[k], randstate, p);
+        fmpz_mul(acc, acc, a[k]);
+        fmpz_mod(acc, acc, p);
+    }
+
+    gghlite_clr_t e[kappa];
+    gghlite_enc_t u[kappa];
+
+    for(size_t k=0; k<kappa; k++) {
+        gghlite_clr_init(e[k]);
+        gghlite_enc_init(u[k], self->params);
+    }
+
+    /* party one: product of level-1 encodings */
+    gghlite_enc_t left;
+    gghlite_enc_init(left, self->params);
+    gghlite_enc_set_ui0(left, 1, self->params);
+
+    for(size_t k=0; k<kappa; k++) {
+        fmpz_poly_set_coeff_fmpz(e[k], 0, a[k]);
+        int group[kappa];
+        memset(group, 0, kappa * sizeof(int));
+        group[0] = 1;
+        gghlite_enc_set_gghlite_clr(u[k], self, e[k], 1, group, 1);
+        gghlite_enc_mul(left, self->params, left, u[k]);
+    }
+
+    /* party two: fresh level-κ encoding of the same product */
+    gghlite_enc_t rght;
+    gghlite_enc_init(rght, self->params);
+    gghlite_enc_set_ui0(rght, 1, self->params);
+
+    fmpz_poly_t tmp; fmpz_poly_init(tmp);
+    fmpz_poly_set_coeff_fmpz(tmp, 0, acc);
+    gghlite_enc_set_gghlite_clr0(rght, self, tmp);
+
+    for(size_t k=0; k<kappa; k++) {
+        gghlite_enc_mul(rght, self->params, rght, self->z_inv[0]);
+    }
+
+    /* both parties derive the same key */
+    unsigned char key_left[GGHLITE_KEY_BYTES];
+    unsigned char key_rght[GGHLITE_KEY_BYTES];
+    gghlite_enc_t scratch;
+    gghlite_enc_init(scratch, self->params);
+    gghlite_enc_extract_key(key_left, self->params, left, scratch);
+    gghlite_enc_extract_key(key_rght, self->params, rght, NULL);
+    if (memcmp(key_left, key_rght, GGHLITE_KEY_BYTES) != 0)
+        status++;
+
+    /* … and agree with extracting first */
+    gghlite_clr_t s_left, s_rght;
+    gghlite_clr_init(s_left);
+    gghlite_clr_init(s_rght);
+    gghlite_enc_extract(s_left, self->params, left);
+    gghlite_enc_extract(s_rght, self->params, rght);
+    if (!fmpz_poly_equal(s_left, s_rght))
+        status++;
+
+    /* a different product gives a different key */
+    gghlite_enc_add(rght, self->params, rght, left);
+    gghlite_enc_extract_key(key_rght, self->params, rght, scratch);
+    if (memcmp(key_left, key_rght, GGHLITE_KEY_BYTES) == 0)
+        status++;
+
+    for(size_t i=0; i<kappa; i++) {
+        fmpz_clear(a[i]);
+        gghlite_clr_clear(e[i]);
+        gghlite_enc_clear(u[i]);
+    }
+
+    gghlite_clr_clear(s_left);
+    gghlite_clr_clear(s_rght);
+    gghlite_enc_clear(scratch);
+    gghlite_enc_clear(left);
+    gghlite_enc_clear(rght);
+    gghlite_clr_clear(tmp);
+    fmpz_clear(acc);
+    fmpz_clear(p);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_extract(20, 2, randstate);
+    status += test_extract(20, 3, randstate);
+    status += test_extract(20, 4, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -0,0 +1,204 @@
+#include <unistd.h>
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+/* size of the file header and offsets of fields that follow it */
+#define HEADER 24
+#define PARAMS_ELL    (HEADER + 6*8)
+#define PARAMS_Q_SIZE (HEADER + 7*8)
+#define ARENA_LEN     (HEADER)
+
+static int
+_overwrite_u64(const char *path, const long offset, const uint64_t x)
+{
+    FILE *fp = fopen(path, "r+b");
+    if (fp == NULL)
+        return -1;
+    int r = fseek(fp, offset, SEEK_SET) || fwrite(&x, sizeof(x), 1, fp) != 1;
+    fclose(fp);
+    return r;
+}
+
+static int
+_params_equal(const gghlite_params_t a, const gghlite_params_t b)
+{
+    int r = (a->lambda == b->lambda) && (a->kappa == b->kappa) && (a->gamma == b->gamma);
+    r = r && (a->n == b->n) && (a->ell == b->ell) && (a->rerand_mask == b->rerand_mask);
+    r = r && fmpz_equal(a->q, b->q) && fmpz_equal(a->ntt->phi, b->ntt->phi) && fmpz_mod_poly_equal(a->pzt, b->pzt);
+    r = r && (mpfr_cmp(a->sigma, b->sigma) == 0) && (mpfr_cmp(a->sigma_s, b->sigma_s) == 0);
+    r = r && (mpfr_cmp(a->xi, b->xi) == 0) && (a->x_len == b->x_len);
+    for(size_t k=0; r && a->x && k<a->kappa; k++)
+        for(size_t j=0; r && a->x[0][k] && j<a->x_len; j++)
+            r = fmpz_mod_poly_equal(a->x[0][k][j], b->x[0][k][j]);
+    return r;
+}
+
+int test_io(const size_t lambda, const size_t kappa, const uint64_t rerand, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu, rerand: 0x%016zx …", lambda, kappa, rerand);
+
+    gghlite_sk_t self;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV;
+    gghlite_init(self, lambda, kappa, kappa, rerand, flags, randstate);
+
+    int status = 0;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/gghlite-test-io-%d.bin", (int)getpid());
+
+    /* params round trip */
+    FILE *fp = fopen(path, "wb");
+    status += (gghlite_params_fwrite(fp, self->params) != 0);
+    fclose(fp);
+
+    gghlite_params_t params;
+    fp = fopen(path, "rb");
+    if (gghlite_params_fread(params, fp) != 0) {
+        status++;
+    } else {
+        status += !_params_equal(self->params, params);
+
+        /* encodings made with the secret key zero-test with the params read back */
+        fmpz_t p; fmpz_init(p);
+        fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+        int group[kappa];
+        memset(group, 0, kappa * sizeof(int));
+        group[0] = 1;
+
+        gghlite_clr_t e; gghlite_clr_init(e);
+        fmpz_t a; fmpz_init(a);
+        fmpz_randm_aes(a, randstate, p);
+        fmpz_poly_set_coeff_fmpz(e, 0, a);
+
+        gghlite_enc_t u, v;
+        gghlite_enc_init(u, params);
+        gghlite_enc_init(v, params);
+        gghlite_enc_set_gghlite_clr(u, self, e, kappa, group, 1);
+        gghlite_enc_set_gghlite_clr(v, self, e, kappa, group, 1);
+        gghlite_enc_sub(u, params, u, v);
+        status += 1 - gghlite_enc_is_zero(params, u);
+        gghlite_enc_add(u, params, v, v);
+        status += gghlite_enc_is_zero(params, u);
+
+        gghlite_enc_clear(u);
+        gghlite_enc_clear(v);
+        fmpz_clear(a);
+        fmpz_clear(p);
+        gghlite_clr_clear(e);
+        gghlite_params_clear(params);
+    }
+    fclose(fp);
+
+    /* the NTT registry is keyed on φ, φ^3 is another primitive 2n-th root with another slot order */
+    fmpz_t phi; fmpz_init(phi);
+    fmpz_powm_ui(phi, self->params->ntt->phi, 3, self->params->q);
+    fmpz_mod_poly_oz_ntt_precomp_struct *ntt = _fmpz_mod_poly_oz_ntt_precomp_ref(self->params->n, self->params->q, phi);
+    status += (ntt == self->params->ntt) || !fmpz_equal(ntt->phi, phi);
+    fmpz_mod_poly_oz_ntt_precomp_unref(ntt);
+    ntt = _fmpz_mod_poly_oz_ntt_precomp_ref(self->params->n, self->params->q, self->params->ntt->phi);
+    status += (ntt != self->params->ntt);
+    fmpz_mod_poly_oz_ntt_precomp_unref(ntt);
+    fmpz_clear(phi);
+
+    /* a limb count larger than the file is rejected instead of allocated */
+    status += (_overwrite_u64(path, PARAMS_Q_SIZE, 0x7fffffffffffffffULL) != 0);
+    fp = fopen(path, "rb");
+    if (gghlite_params_fread(params, fp) == 0) {
+        status++;
+        gghlite_params_clear(params);
+    }
+    fclose(fp);
+
+    /* φ must satisfy φ^n = -1 mod q and ℓ must not exceed log(q) */
+    const long phi_low = PARAMS_Q_SIZE + 8 + 8*fmpz_size(self->params->q) + 8;
+    const long offset[2] = {phi_low, PARAMS_ELL};
+    const uint64_t value[2] = {2, fmpz_sizeinbase(self->params->q, 2) + 1};
+    for(int i=0; i<2; i++) {
+        fp = fopen(path, "wb");
+        status += (gghlite_params_fwrite(fp, self->params) != 0);
+        fclose(fp);
+        status += (_overwrite_u64(path, offset[i], value[i]) != 0);
+        fp = fopen(path, "rb");
+        if (gghlite_params_fread(params, fp) == 0) {
+            status++;
+            gghlite_params_clear(params);
+        }
+        fclose(fp);
+    }
+
+    /* truncated files are rejected */
+    fp = fopen(path, "wb");
+    status += (gghlite_params_fwrite(fp, self->params) != 0);
+    fclose(fp);
+    status += (truncate(path, HEADER + 8*8) != 0);
+    fp = fopen(path, "rb");
+    if (gghlite_params_fread(params, fp) == 0) {
+        status++;
+        gghlite_params_clear(params);
+    }
+    fclose(fp);
+
+    /* arena round trip */
+    const size_t len = 3;
+    gghlite_enc_arena_t arena;
+    gghlite_enc_arena_init(arena, self->params, len, 0);
+    gghlite_enc_t t, s;
+    gghlite_enc_init(t, self->params);
+    gghlite_enc_init(s, self->params);
+    for(size_t i=0; i<len; i++) {
+        fmpz_mod_poly_randtest_aes(t, randstate, self->params->n);
+        gghlite_enc_arena_set_gghlite_enc(arena, i, t);
+    }
+
+    fp = fopen(path, "wb");
+    status += (gghlite_enc_arena_fwrite(fp, arena) != 0);
+    fclose(fp);
+
+    gghlite_enc_arena_t mapped;
+    if (gghlite_enc_arena_mmap(mapped, self->params, path) != 0) {
+        status++;
+    } else {
+        status += (mapped->len != len);
+        for(size_t i=0; i<len && i<mapped->len; i++) {
+            gghlite_enc_set_gghlite_enc_arena(t, arena, i);
+            gghlite_enc_set_gghlite_enc_arena(s, mapped, i);
+            status += !fmpz_mod_poly_equal(t, s);
+        }
+        gghlite_enc_arena_clear(mapped);
+    }
+
+    /* a length that would overflow the size check is rejected */
+    status += (_overwrite_u64(path, ARENA_LEN, ((uint64_t)1)<<62) != 0);
+    if (gghlite_enc_arena_mmap(mapped, self->params, path) == 0) {
+        status++;
+        gghlite_enc_arena_clear(mapped);
+    }
+
+    unlink(path);
+    gghlite_enc_clear(t);
+    gghlite_enc_clear(s);
+    gghlite_enc_arena_clear(arena);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_io(20, 2, 0x0, randstate);
+    status += test_io(20, 3, 0x1, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
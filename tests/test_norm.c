@@ -1,3 +1,4 @@
+#include <aesrand.h>
 #include <oz/oz.h>
 #include <oz/util.h>
 #include <math.h>
@@ -39,6 +40,47 @@ int test_nmod_poly_oz_ideal_norm(slong n, aes_randstate_t state) {
   return !r;
 }
 
+int test_nmod_vec_oz_ntt_kernel(const size_t k, aes_randstate_t state) {
+  const size_t n = ((size_t)1)<<k;
+
+  nmod_t q;
+  nmod_init(&q, _n_next_oz_good_probaprime((UWORD(1)<<(FLINT_BITS-3)) + 1, 2*n));
+  const mp_limb_t phi = _nmod_nth_root(2*n, q.n);
+
+  mp_ptr w = _nmod_vec_init(n);
+  mp_ptr w_pre = _nmod_vec_init(n);
+  _nmod_vec_oz_set_powers_shoup(w, w_pre, n, phi, q);
+
+  nmod_poly_t f;
+  nmod_poly_init2(f, q.n, n);
+  nmod_poly_randtest_aes(f, state, n);
+
+  mp_ptr a0 = _nmod_vec_init(n);
+  mp_ptr a1 = _nmod_vec_init(n);
+  for(size_t i=0; i<n; i++)
+    a0[i] = nmod_poly_get_coeff_ui(f, i);
+  _nmod_vec_set(a1, a0, n);
+
+  _nmod_vec_oz_ntt_func kernel = _nmod_vec_oz_ntt_get_kernel(n);
+  kernel(a0, w, w_pre, n, q);
+  _nmod_vec_oz_ntt_generic(a1, w, w_pre, n, q);
+
+  int r = (kernel != _nmod_vec_oz_ntt_generic) && _nmod_vec_equal(a0, a1, n);
+
+  printf("n: %6zu, specialised kernel ", n);
+  if (r)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+
+  _nmod_vec_clear(a0);
+  _nmod_vec_clear(a1);
+  _nmod_vec_clear(w);
+  _nmod_vec_clear(w_pre);
+  nmod_poly_clear(f);
+  return !r;
+}
+
 int test_fmpz_poly_oz_ideal_norm(slong n, mp_bitcnt_t bits, aes_randstate_t state) {
   fmpz_poly_t f;
   fmpz_poly_t g;
@@ -168,6 +210,13 @@ int main(int argc, char *argv[]) {
     status += test_nmod_poly_oz_ideal_norm(n[i],state);
   }
 
+  for(size_t k=OZ_NMOD_NTT_MIN_LOG; k<=OZ_NMOD_NTT_MAX_LOG; k++)
+    status += test_nmod_vec_oz_ntt_kernel(k, state);
+
+  /* above OZ_NMOD_NTT_BLOCK limbs the resultant NTT switches to depth-first sub-transforms */
+  status += test_nmod_poly_oz_ideal_norm(1L<<12, state);
+  status += test_nmod_poly_oz_ideal_norm(1L<<14, state);
+
   aes_randclear(state);
   flint_cleanup();
   return status;
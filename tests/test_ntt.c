@@ -0,0 +1,365 @@
+#include <omp.h>
+#include <aesrand.h>
+#include <oz/oz.h>
+#include <oz/ntt.h>
+#include <oz/util.h>
+#include <oz/flint-addons.h>
+
+/* smallest prime q ≡ 1 mod 2n above 2^bits */
+
+static void _prime(fmpz_t q, const size_t n, const mp_bitcnt_t bits) {
+  fmpz_one(q);
+  fmpz_mul_2exp(q, q, bits);
+  fmpz_add_ui(q, q, 1);
+  while (!fmpz_is_probabprime(q))
+    fmpz_add_ui(q, q, 2*n);
+}
+
+static void _randm(fmpz_mod_poly_t f, const size_t len, aes_randstate_t randstate) {
+  fmpz_t c; fmpz_init(c);
+  fmpz_mod_poly_zero(f);
+  for(size_t i=0; i<len; i++) {
+    fmpz_randm_aes(c, randstate, &f->p);
+    fmpz_mod_poly_set_coeff_fmpz(f, i, c);
+  }
+  fmpz_clear(c);
+}
+
+int test_precomp_registry(const size_t n, const mp_bitcnt_t bits, aes_randstate_t randstate) {
+  printf("n: %5zu, log(q): %4lu, registry …", n, bits);
+
+  int status = 0;
+
+  fmpz_t q; fmpz_init(q);
+  _prime(q, n, bits);
+
+  /* unreferenced entries are kept, back-to-back standalone requests share them */
+  fmpz_t phi; fmpz_init(phi);
+  fmpz_mod_poly_oz_ntt_precomp_struct *a = fmpz_mod_poly_oz_ntt_precomp_ref(n, q);
+  fmpz_powm_ui(phi, a->phi, 3, q);
+  fmpz_mod_poly_oz_ntt_precomp_unref(a);
+  fmpz_mod_poly_oz_ntt_precomp_struct *b = fmpz_mod_poly_oz_ntt_precomp_ref(n, q);
+  fmpz_mod_poly_oz_ntt_precomp_unref(b);
+  status += (a != b);
+
+  /* φ^3 is another primitive 2n-th root of unity, it gets its own entry and root-less requests ignore it */
+  fmpz_mod_poly_oz_ntt_precomp_struct *c = _fmpz_mod_poly_oz_ntt_precomp_ref(n, q, phi);
+  status += (c == a) || !fmpz_equal(c->phi, phi);
+  b = fmpz_mod_poly_oz_ntt_precomp_ref(n, q);
+  status += (b != a);
+  fmpz_mod_poly_oz_ntt_precomp_unref(b);
+
+  /* standalone transforms round trip whichever entries come and go in between */
+  fmpz_mod_poly_t f, g, h;
+  fmpz_mod_poly_init(f, q);
+  fmpz_mod_poly_init(g, q);
+  fmpz_mod_poly_init(h, q);
+  _randm(f, n, randstate);
+
+  fmpz_mod_poly_oz_ntt(g, f, n);
+  fmpz_mod_poly_oz_ntt_precomp_unref(c);
+  fmpz_mod_poly_oz_ntt_precomp_flush();
+  fmpz_mod_poly_oz_intt(h, g, n);
+
+  /* the inverse transform is not scaled by 1/n */
+  fmpz_set_ui(phi, n);
+  fmpz_mod_poly_scalar_mul_fmpz(g, f, phi);
+  _fmpz_mod_poly_normalise(h);
+  status += !fmpz_mod_poly_equal(g, h);
+
+  fmpz_mod_poly_oz_ntt_precomp_flush();
+
+  fmpz_mod_poly_clear(f);
+  fmpz_mod_poly_clear(g);
+  fmpz_mod_poly_clear(h);
+  fmpz_clear(phi);
+  fmpz_clear(q);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+/* run the cyclic (k=0), negacyclic (k=1) or inverse negacyclic (k=2) transform of f with t threads */
+
+static void _ntt_threads(fmpz *a, const fmpz_mod_poly_t f, const fmpz_mod_poly_oz_ntt_precomp_t precomp,
+                         const int k, const int t) {
+  const size_t n = precomp->n;
+  fmpz_t tmp; fmpz_init(tmp);
+  fmpz_t quo; fmpz_init(quo);
+  _fmpz_vec_zero(a, n);
+  _fmpz_vec_set(a, f->coeffs, f->length);
+
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(t);
+  if (k == 0)
+    _fmpz_vec_oz_ntt(a, precomp->w->coeffs, n, &f->p, tmp);
+  else if (k == 1)
+    _fmpz_vec_oz_ntt_nwc(a, precomp, tmp, quo);
+  else
+    _fmpz_vec_oz_intt_nwc(a, precomp, tmp, quo);
+  omp_set_num_threads(threads);
+
+  fmpz_clear(quo);
+  fmpz_clear(tmp);
+}
+
+int test_ntt_parallel(const size_t n, const mp_bitcnt_t bits, aes_randstate_t randstate) {
+  printf("n: %5zu, log(q): %4lu, parallel …", n, bits);
+
+  int status = 0;
+
+  fmpz_t q; fmpz_init(q);
+  _prime(q, n, bits);
+
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
+
+  fmpz_mod_poly_t f;
+  fmpz_mod_poly_init(f, q);
+  fmpz *a = _fmpz_vec_init(n);
+  fmpz *b = _fmpz_vec_init(n);
+
+  /* the parallel transforms must be bit-identical to the serial ones for any number of threads */
+  const int t[] = {2, 3, 4, 8};
+  for(int k=0; k<3; k++) {
+    _randm(f, n, randstate);
+    _ntt_threads(a, f, precomp, k, 1);
+    for(size_t l=0; l<sizeof(t)/sizeof(t[0]); l++) {
+      _ntt_threads(b, f, precomp, k, t[l]);
+      status += !_fmpz_vec_equal(a, b, n);
+    }
+  }
+
+  _fmpz_vec_clear(a, n);
+  _fmpz_vec_clear(b, n);
+  fmpz_mod_poly_clear(f);
+  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_clear(q);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+/* NTT domain elements carry all n slots */
+
+static void _pad(fmpz_mod_poly_t f, const size_t n) {
+  fmpz_mod_poly_fit_length(f, n);
+  _fmpz_vec_zero(f->coeffs + f->length, n - f->length);
+  _fmpz_mod_poly_set_length(f, n);
+}
+
+/* every invertible slot of h must be the inverse of the slot of f, as computed by fmpz_invmod */
+
+static int _check_inv(fmpz_mod_poly_t *h, fmpz_mod_poly_t *f, const size_t len, const size_t n) {
+  int status = 0;
+  fmpz_t r; fmpz_init(r);
+  fmpz_t t; fmpz_init(t);
+  for(size_t i=0; i<len; i++) {
+    status += (h[i]->length != (long)n);
+    for(size_t j=0; j<n; j++) {
+      if (!fmpz_invmod(r, f[i]->coeffs + j, &f[i]->p))
+        continue;
+      fmpz_mul(t, f[i]->coeffs + j, h[i]->coeffs + j);
+      fmpz_mod(t, t, &f[i]->p);
+      status += !fmpz_equal(h[i]->coeffs + j, r) || !fmpz_is_one(t);
+    }
+  }
+  fmpz_clear(t);
+  fmpz_clear(r);
+  return status;
+}
+
+int test_ntt_inv_batch(const size_t n, const size_t len, const mp_bitcnt_t bits, aes_randstate_t randstate) {
+  printf("n: %5zu, len: %2zu, log(q): %4lu, inv_batch …", n, len, bits);
+
+  int status = 0;
+
+  /* a product of two primes as for RNS moduli */
+  fmpz_t p0; fmpz_init(p0);
+  fmpz_t p1; fmpz_init(p1);
+  fmpz_t q;  fmpz_init(q);
+  _prime(p0, n, bits/2);
+  _prime(p1, n, bits - bits/2);
+  fmpz_mul(q, p0, p1);
+
+  fmpz_mod_poly_t f[len], g[len], h[len];
+  for(size_t i=0; i<len; i++) {
+    fmpz_mod_poly_init(f[i], q);
+    fmpz_mod_poly_init(g[i], q);
+    fmpz_mod_poly_init(h[i], q);
+    _randm(f[i], n, randstate);
+    _pad(f[i], n);
+  }
+
+  /* all slots invertible */
+  fmpz_mod_poly_oz_ntt_inv_batch(h, f, len, n);
+  status += _check_inv(h, f, len, n);
+
+  /* one element with a zero slot and a slot sharing a factor with q, the other slots must still be inverted */
+  const size_t k = len/2;
+  fmpz_zero(f[k]->coeffs + n/2);
+  fmpz_set(f[k]->coeffs + n/2 + 1, p0);
+  fmpz_mul_ui(f[k]->coeffs + n - 1, p1, 3);
+  fmpz_mod_poly_oz_ntt_inv_batch(h, f, len, n);
+  status += _check_inv(h, f, len, n);
+
+  /* also with a single element and with a single thread */
+  fmpz_mod_poly_oz_ntt_inv(h[k], f[k], n);
+  status += _check_inv(h + k, f + k, 1, n);
+
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  fmpz_mod_poly_oz_ntt_inv_batch(h, f, len, n);
+  omp_set_num_threads(threads);
+  status += _check_inv(h, f, len, n);
+
+  /* aliased */
+  for(size_t i=0; i<len; i++) {
+    fmpz_mod_poly_set(g[i], f[i]);
+    _pad(g[i], n);
+  }
+  fmpz_mod_poly_oz_ntt_inv_batch(g, g, len, n);
+  status += _check_inv(g, f, len, n);
+
+  for(size_t i=0; i<len; i++) {
+    fmpz_mod_poly_clear(f[i]);
+    fmpz_mod_poly_clear(g[i]);
+    fmpz_mod_poly_clear(h[i]);
+  }
+  fmpz_clear(q);
+  fmpz_clear(p1);
+  fmpz_clear(p0);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+/* rop = Σ f_k · g_k by repeated multiplication and addition */
+
+static void _inner_product_ref(fmpz_mod_poly_t rop, fmpz_mod_poly_t *f, fmpz_mod_poly_t *g, const size_t len,
+                               const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  fmpz_mod_poly_t t;
+  fmpz_mod_poly_init(t, &rop->p);
+  fmpz_mod_poly_zero(rop);
+  for(size_t k=0; k<len; k++) {
+    _fmpz_mod_poly_oz_ntt_mul(t, f[k], g[k], precomp);
+    _fmpz_mod_poly_normalise(t);
+    fmpz_mod_poly_add(rop, rop, t);
+  }
+  fmpz_mod_poly_clear(t);
+}
+
+int test_ntt_inner_product(const size_t n, const size_t len, const mp_bitcnt_t bits, aes_randstate_t randstate) {
+  printf("n: %5zu, len: %2zu, log(q): %4lu, inner product …", n, len, bits);
+
+  int status = 0;
+
+  fmpz_t q; fmpz_init(q);
+  _prime(q, n, bits);
+
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
+
+  fmpz_mod_poly_t f[len], g[len], r, s;
+  for(size_t k=0; k<len; k++) {
+    fmpz_mod_poly_init(f[k], q);
+    fmpz_mod_poly_init(g[k], q);
+    _randm(f[k], n, randstate);
+    _randm(g[k], n, randstate);
+    _pad(f[k], n);
+    _pad(g[k], n);
+  }
+  fmpz_mod_poly_init(r, q);
+  fmpz_mod_poly_init(s, q);
+
+  /* whatever rop holds is overwritten, including for len = 0 */
+  for(size_t l=0; l<=len; l++) {
+    _inner_product_ref(r, f, g, l, precomp);
+    _randm(s, n, randstate);
+    _fmpz_mod_poly_oz_ntt_inner_product(s, f, g, l, precomp);
+    _fmpz_mod_poly_normalise(s);
+    status += !fmpz_mod_poly_equal(r, s);
+  }
+
+  /* h + f·g */
+  _randm(s, n, randstate);
+  _pad(s, n);
+  _fmpz_mod_poly_oz_ntt_mul(r, f[0], g[0], precomp);
+  fmpz_mod_poly_add(r, r, s);
+  _fmpz_mod_poly_oz_ntt_addmul(s, f[0], g[0], precomp);
+  _fmpz_mod_poly_normalise(s);
+  status += !fmpz_mod_poly_equal(r, s);
+
+  /* a zero accumulator has no slots */
+  _fmpz_mod_poly_oz_ntt_mul(r, f[0], g[0], precomp);
+  _fmpz_mod_poly_normalise(r);
+  fmpz_mod_poly_zero(s);
+  _fmpz_mod_poly_oz_ntt_addmul(s, f[0], g[0], precomp);
+  _fmpz_mod_poly_normalise(s);
+  status += !fmpz_mod_poly_equal(r, s);
+
+  /* aliased, f_0 = f_0 + f_0·g_0 */
+  _fmpz_mod_poly_oz_ntt_mul(r, f[0], g[0], precomp);
+  fmpz_mod_poly_add(r, r, f[0]);
+  _fmpz_mod_poly_oz_ntt_addmul(f[0], f[0], g[0], precomp);
+  _fmpz_mod_poly_normalise(f[0]);
+  status += !fmpz_mod_poly_equal(r, f[0]);
+  _pad(f[0], n);
+
+  /* aliased, rop is some f_k and then some g_k */
+  _inner_product_ref(r, f, g, len, precomp);
+  fmpz_mod_poly_set(s, f[len-1]);
+  _fmpz_mod_poly_oz_ntt_inner_product(f[len-1], f, g, len, precomp);
+  _fmpz_mod_poly_normalise(f[len-1]);
+  status += !fmpz_mod_poly_equal(r, f[len-1]);
+  fmpz_mod_poly_set(f[len-1], s);
+  _pad(f[len-1], n);
+
+  _fmpz_mod_poly_oz_ntt_inner_product(g[0], f, g, len, precomp);
+  _fmpz_mod_poly_normalise(g[0]);
+  status += !fmpz_mod_poly_equal(r, g[0]);
+
+  for(size_t k=0; k<len; k++) {
+    fmpz_mod_poly_clear(f[k]);
+    fmpz_mod_poly_clear(g[k]);
+  }
+  fmpz_mod_poly_clear(r);
+  fmpz_mod_poly_clear(s);
+  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_clear(q);
+
+  if (status == 0)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+  return status;
+}
+
+int main(int argc, char *argv[]) {
+  aes_randstate_t randstate;
+  aes_randinit(randstate);
+
+  int status = 0;
+
+  status += test_precomp_registry(16, 40, randstate);
+  status += test_precomp_registry(1024, 80, randstate);
+  status += test_ntt_parallel(OZ_NTT_PARALLEL_THRESHOLD, 80, randstate);
+  status += test_ntt_parallel(4*OZ_NTT_PARALLEL_THRESHOLD, 160, randstate);
+  status += test_ntt_inv_batch(16, 3, 80, randstate);
+  status += test_ntt_inv_batch(1024, 4, 160, randstate);
+  status += test_ntt_inner_product(16, 3, 80, randstate);
+  status += test_ntt_inner_product(OZ_NTT_PARALLEL_THRESHOLD, 5, 160, randstate);
+
+  aes_randclear(randstate);
+  flint_cleanup();
+  return status;
+}
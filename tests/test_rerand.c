@@ -0,0 +1,100 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+int test_rerand(const size_t lambda, const size_t kappa, const uint64_t rerand, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu, rerand: 0x%016zx …", lambda, kappa, rerand);
+
+    gghlite_sk_t self;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV;
+    gghlite_init(self, lambda, kappa, kappa, rerand, flags, randstate);
+
+    int status = 0;
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    int group[kappa];
+    memset(group, 0, kappa * sizeof(int));
+    group[0] = 1;
+
+    fmpz_t a, b, ab;
+    fmpz_init(a);
+    fmpz_init(b);
+    fmpz_init(ab);
+
+    gghlite_clr_t e; gghlite_clr_init(e);
+    gghlite_enc_t u, v, w, t;
+    gghlite_enc_init(u, self->params);
+    gghlite_enc_init(v, self->params);
+    gghlite_enc_init(w, self->params);
+    gghlite_enc_init(t, self->params);
+
+    for(size_t k=1; k<=kappa; k++) {
+        if (!gghlite_params_have_rerand(self->params, k-1))
+            continue;
+
+        fmpz_randm_aes(a, randstate, p);
+        fmpz_randm_aes(b, randstate, p);
+        fmpz_mul(ab, a, b);
+        fmpz_mod(ab, ab, p);
+
+        /* v = rerand(enc(a, k)) */
+        fmpz_poly_zero(e);
+        fmpz_poly_set_coeff_fmpz(e, 0, a);
+        gghlite_enc_set_gghlite_clr(u, self, e, k, group, 0);
+        gghlite_enc_rerand(v, self->params, u, k, 0, randstate);
+        if (fmpz_mod_poly_equal(u, v))
+            status++;
+
+        /* v·enc(b, κ-k) - enc(a·b, κ) is an encoding of zero */
+        fmpz_poly_zero(e);
+        fmpz_poly_set_coeff_fmpz(e, 0, b);
+        gghlite_enc_set_gghlite_clr(w, self, e, kappa - k, group, 0);
+        gghlite_enc_mul(v, self->params, v, w);
+
+        fmpz_poly_zero(e);
+        fmpz_poly_set_coeff_fmpz(e, 0, ab);
+        gghlite_enc_set_gghlite_clr(t, self, e, kappa, group, 0);
+        gghlite_enc_sub(t, self->params, t, v);
+        status += 1 - gghlite_enc_is_zero(self->params, t);
+
+        /* but not of anything else */
+        gghlite_enc_add(t, self->params, t, v);
+        gghlite_enc_add(t, self->params, t, v);
+        status += gghlite_enc_is_zero(self->params, t);
+    }
+
+    fmpz_clear(a);
+    fmpz_clear(b);
+    fmpz_clear(ab);
+    fmpz_clear(p);
+    gghlite_clr_clear(e);
+    gghlite_enc_clear(u);
+    gghlite_enc_clear(v);
+    gghlite_enc_clear(w);
+    gghlite_enc_clear(t);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_rerand(20, 2, 0x1, randstate);
+    status += test_rerand(20, 3, 0x6, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -0,0 +1,138 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+int test_rns(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu …", lambda, kappa);
+
+    gghlite_sk_t self;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV | GGHLITE_FLAGS_RNS;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, flags, randstate);
+
+    int status = 0;
+
+    /* q = ∏ p_i */
+    fmpz_t q; fmpz_init_set_ui(q, 1);
+    for(size_t i=0; i<self->params->rns->k; i++) {
+        if ((self->params->rns->p[i] % (2*self->params->n)) != 1)
+            status++;
+        fmpz_mul_ui(q, q, self->params->rns->p[i]);
+    }
+    if (!fmpz_equal(q, self->params->q))
+        status++;
+    fmpz_clear(q);
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    fmpz_t a[kappa];
+    fmpz_t acc;  fmpz_init(acc);
+    fmpz_set_ui(acc, 1);
+
+    for(size_t k=0; k<kappa; k++) {
+        fmpz_init(a[k]);
+        fmpz_randm_aes(a[k], randstate, p);
+        fmpz_mul(acc, acc, a[k]);
+        fmpz_mod(acc, acc, p);
+    }
+
+    gghlite_clr_t e[kappa];
+    gghlite_enc_t u[kappa];
+
+    for(size_t k=0; k<kappa; k++) {
+        gghlite_clr_init(e[k]);
+        gghlite_enc_init(u[k], self->params);
+    }
+
+    gghlite_enc_t left;
+    gghlite_enc_init(left, self->params);
+    gghlite_enc_set_ui0(left, 1, self->params);
+
+    gghlite_enc_rns_t left_rns, u_rns;
+    gghlite_enc_rns_init(left_rns, self->params);
+    gghlite_enc_rns_init(u_rns, self->params);
+    gghlite_enc_rns_set_gghlite_enc(left_rns, self->params, left);
+
+    for(size_t k=0; k<kappa; k++) {
+        fmpz_poly_set_coeff_fmpz(e[k], 0, a[k]);
+        int group[kappa];
+        memset(group, 0, kappa * sizeof(int));
+        group[0] = 1;
+        gghlite_enc_set_gghlite_clr(u[k], self, e[k], 1, group, 1);
+        gghlite_enc_mul(left, self->params, left, u[k]);
+
+        gghlite_enc_rns_set_gghlite_enc(u_rns, self->params, u[k]);
+        gghlite_enc_rns_mul(left_rns, self->params, left_rns, u_rns);
+    }
+
+    /* RNS and multi-precision products agree */
+    gghlite_enc_t t;
+    gghlite_enc_init(t, self->params);
+    gghlite_enc_set_gghlite_enc_rns(t, self->params, left_rns);
+    if (!fmpz_mod_poly_equal(t, left))
+        status++;
+
+    gghlite_enc_t rght;
+    gghlite_enc_init(rght, self->params);
+    gghlite_enc_set_ui0(rght, 1, self->params);
+
+    fmpz_poly_t tmp; fmpz_poly_init(tmp);
+    fmpz_poly_set_coeff_fmpz(tmp, 0, acc);
+    gghlite_enc_set_gghlite_clr0(rght, self, tmp);
+
+    for(size_t k=0; k<kappa; k++) {
+        gghlite_enc_mul(rght, self->params, rght, self->z_inv[0]);
+    }
+
+    gghlite_enc_rns_t rght_rns;
+    gghlite_enc_rns_init(rght_rns, self->params);
+    gghlite_enc_rns_set_gghlite_enc(rght_rns, self->params, rght);
+
+    gghlite_enc_rns_sub(rght_rns, self->params, rght_rns, left_rns);
+    status += 1 - gghlite_enc_rns_is_zero(self->params, rght_rns);
+
+    /* adding the product back must not be zero */
+    gghlite_enc_rns_add(rght_rns, self->params, rght_rns, left_rns);
+    gghlite_enc_rns_add(rght_rns, self->params, rght_rns, left_rns);
+    status += gghlite_enc_rns_is_zero(self->params, rght_rns);
+
+    for(size_t i=0; i<kappa; i++) {
+        fmpz_clear(a[i]);
+        gghlite_clr_clear(e[i]);
+        gghlite_enc_clear(u[i]);
+    }
+
+    gghlite_enc_rns_clear(left_rns);
+    gghlite_enc_rns_clear(u_rns);
+    gghlite_enc_rns_clear(rght_rns);
+    gghlite_enc_clear(t);
+    gghlite_enc_clear(left);
+    gghlite_enc_clear(rght);
+    gghlite_clr_clear(tmp);
+    fmpz_clear(acc);
+    fmpz_clear(p);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_rns(20, 2, randstate);
+    status += test_rns(20, 3, randstate);
+    status += test_rns(20, 4, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -0,0 +1,201 @@
+#include <pthread.h>
+#include <unistd.h>
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+/* wire format of requests and responses, see gghlite/server.c */
+
+struct _raw_request {
+    uint32_t op;
+    uint32_t flags;
+    uint64_t id;
+    uint64_t len;
+};
+
+struct _raw_response {
+    uint32_t status;
+    uint32_t reserved;
+    uint64_t id;
+    uint64_t latency;
+    uint64_t len;
+};
+
+/* send a product request whose first coefficient claims far more limbs than the payload holds */
+static int send_malformed(int fd) {
+    const uint64_t payload[3] = {1, 0x7fffffffffffffffULL, 0};
+    struct _raw_request request = {2, 0, 0x1234, sizeof(payload)};
+    if (write(fd, &request, sizeof(request)) != sizeof(request) ||
+        write(fd, payload, sizeof(payload)) != sizeof(payload))
+        return -1;
+
+    struct _raw_response response;
+    if (read(fd, &response, sizeof(response)) != sizeof(response))
+        return -1;
+    return (response.status != 0 && response.id == 0x1234 && response.len == 0) ? 0 : -1;
+}
+
+/* send only the header of a request, return the connection */
+static int send_header(const char *path, const uint64_t len) {
+    int fd = gghlite_client_connect(path);
+    struct _raw_request request = {3, 0, 0x5678, len};
+    if (fd >= 0 && write(fd, &request, sizeof(request)) != sizeof(request)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct _server_args {
+    struct _gghlite_sk_struct *self;
+    const char *path;
+    int status;
+};
+
+static void *serve(void *arg) {
+    struct _server_args *args = (struct _server_args *)arg;
+    args->status = gghlite_server_run(args->self, args->path, 16);
+    return NULL;
+}
+
+int test_server(const size_t lambda, const size_t kappa, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, κ: %2zu …", lambda, kappa);
+
+    gghlite_sk_t self;
+    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, flags, randstate);
+
+    int status = 0;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/gghlite-test-%d.sock", (int)getpid());
+
+    /* files other than sockets are not replaced */
+    FILE *fp = fopen(path, "w");
+    fclose(fp);
+    if (gghlite_server_run(self, path, 16) != -1 || access(path, F_OK) != 0)
+        status++;
+    unlink(path);
+
+    struct _server_args args = {self, path, -1};
+    pthread_t thread;
+    pthread_create(&thread, NULL, serve, &args);
+
+    int fd = -1;
+    for(int i=0; i<100 && fd < 0; i++) {
+        fd = gghlite_client_connect(path);
+        if (fd < 0)
+            usleep(10000);
+    }
+    if (fd < 0) {
+        printf(" FAIL (connect)\n");
+        return 1;
+    }
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    int group[kappa];
+    memset(group, 0, kappa * sizeof(int));
+    group[0] = 1;
+
+    gghlite_clr_t e; gghlite_clr_init(e);
+    fmpz_t a; fmpz_init(a);
+
+    gghlite_enc_t u, left, t;
+    gghlite_enc_init(u, self->params);
+    gghlite_enc_init(left, self->params);
+    gghlite_enc_init(t, self->params);
+
+    /* encode and multiply through the server */
+    fmpz_t acc; fmpz_init_set_ui(acc, 1);
+    uint64_t latency = 0;
+
+    for(size_t k=0; k<kappa; k++) {
+        fmpz_randm_aes(a, randstate, p);
+        fmpz_mul(acc, acc, a);
+        fmpz_mod(acc, acc, p);
+        fmpz_poly_set_coeff_fmpz(e, 0, a);
+        if (gghlite_client_enc_set_gghlite_clr(u, fd, self->params, e, 1, group, 1, &latency))
+            status++;
+        if (k == 0)
+            gghlite_enc_set(left, u);
+        else if (gghlite_client_enc_mul(left, fd, self->params, left, u, &latency))
+            status++;
+    }
+
+    /* the server's product is an encoding of ∏ a_i at level κ */
+    fmpz_poly_zero(e);
+    fmpz_poly_set_coeff_fmpz(e, 0, acc);
+    gghlite_enc_set_gghlite_clr(t, self, e, kappa, group, 0);
+    gghlite_enc_sub(t, self->params, t, left);
+
+    status += 1 - gghlite_client_enc_is_zero(fd, self->params, t, &latency);
+    gghlite_enc_add(t, self->params, t, left);
+    gghlite_enc_add(t, self->params, t, left);
+    status += gghlite_client_enc_is_zero(fd, self->params, t, &latency);
+
+    /* malformed payloads are rejected and the server keeps serving */
+    if (send_malformed(fd))
+        status++;
+    if (gghlite_client_enc_is_zero(fd, self->params, t, &latency) != 0)
+        status++;
+
+    /* a client stalling in the middle of a request is dropped and does not block others */
+    int stalled = send_header(path, 64);
+    status += (stalled < 0);
+    usleep(10000);
+    status += (gghlite_client_enc_is_zero(fd, self->params, t, &latency) != 0);
+    if (stalled >= 0)
+        close(stalled);
+
+    /* payloads larger than any valid request are refused by hanging up */
+    int oversized = send_header(path, ((uint64_t)1)<<30);
+    status += (oversized < 0);
+    if (oversized >= 0) {
+        struct _raw_response response;
+        status += (read(oversized, &response, sizeof(response)) > 0);
+        close(oversized);
+    }
+
+    /* requests at levels the instance does not support are rejected, not fatal */
+    if (gghlite_client_enc_set_gghlite_clr(u, fd, self->params, e, kappa + 1, group, 0, NULL) != -1)
+        status++;
+
+    if (gghlite_client_shutdown(fd))
+        status++;
+    close(fd);
+    pthread_join(thread, NULL);
+    status += (args.status != 0);
+
+    fmpz_clear(acc);
+    fmpz_clear(a);
+    fmpz_clear(p);
+    gghlite_clr_clear(e);
+    gghlite_enc_clear(u);
+    gghlite_enc_clear(left);
+    gghlite_enc_clear(t);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_server(20, 2, randstate);
+    status += test_server(20, 3, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -0,0 +1,136 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+
+/* encode c at level k in `group` twice, the second time with a warm cache, both must agree */
+
+static int _enc_warm(gghlite_enc_t rop, const gghlite_sk_t self, const fmpz_t c, const size_t k, int *group) {
+    gghlite_clr_t e; gghlite_clr_init(e);
+    fmpz_poly_set_coeff_fmpz(e, 0, c);
+
+    gghlite_enc_t cold;
+    gghlite_enc_init(cold, self->params);
+    gghlite_enc_set_gghlite_clr(cold, self, e, k, group, 0);
+    gghlite_enc_set_gghlite_clr(rop, self, e, k, group, 0);
+
+    int status = !fmpz_mod_poly_equal(cold, rop);
+
+    gghlite_enc_clear(cold);
+    gghlite_clr_clear(e);
+    return status;
+}
+
+int test_z_inv_cache(const size_t lambda, const size_t kappa, const gghlite_flag_t flags, aes_randstate_t randstate) {
+    const int symmetric = !(flags & GGHLITE_FLAGS_ASYMMETRIC);
+
+    printf("λ: %4zu, κ: %2zu, symmetric: %d …", lambda, kappa, symmetric);
+
+    gghlite_sk_t self;
+    gghlite_init(self, lambda, kappa, kappa, 0x0, flags | GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV, randstate);
+
+    int status = 0;
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    fmpz_t a, b, ab;
+    fmpz_init(a);
+    fmpz_init(b);
+    fmpz_init(ab);
+    fmpz_randm_aes(a, randstate, p);
+    fmpz_randm_aes(b, randstate, p);
+    fmpz_mul(ab, a, b);
+    fmpz_mod(ab, ab, p);
+
+    /* symmetric: a at level 1, b at level κ-1; asymmetric: a in group 0, b in the remaining groups */
+    const size_t gamma = self->params->gamma;
+    int group_a[gamma], group_b[gamma], group_ab[gamma];
+    for(size_t i=0; i<gamma; i++) {
+        group_a[i]  = (i == 0);
+        group_b[i]  = (i != 0);
+        group_ab[i] = 1;
+    }
+    if (symmetric)
+        group_b[0] = 1;
+
+    gghlite_enc_t u, v, w;
+    gghlite_enc_init(u, self->params);
+    gghlite_enc_init(v, self->params);
+    gghlite_enc_init(w, self->params);
+
+    /* with a full cache products are computed on the fly */
+    const size_t alloc = self->z_inv_cache->alloc;
+    const size_t len = self->z_inv_cache->len;
+    self->z_inv_cache->alloc = len;
+    status += _enc_warm(w, self, a, 1, group_a);
+    status += (self->z_inv_cache->len != len);
+    self->z_inv_cache->alloc = alloc;
+
+    status += _enc_warm(u, self, a, 1, group_a);
+    status += !fmpz_mod_poly_equal(u, w);
+    status += _enc_warm(v, self, b, symmetric ? kappa - 1 : 1, group_b);
+    status += _enc_warm(w, self, ab, symmetric ? kappa : 1, group_ab);
+
+    /* the cached products are those of the z_i^{-1} */
+    for(size_t l=0; l<3; l++) {
+        int *group = (l == 0) ? group_a : ((l == 1) ? group_b : group_ab);
+        const size_t k = (l == 0) ? 1 : ((l == 1) ? kappa - 1 : kappa);
+        gghlite_enc_t c, d;
+        gghlite_enc_init(c, self->params);
+        gghlite_enc_init(d, self->params);
+        fmpz_mod_poly_oz_ntt_set_ui(c, 1, self->params->n);
+        fmpz_mod_poly_oz_ntt_set_ui(d, 1, self->params->n);
+        _gghlite_sk_mul_z_inv(c, self, symmetric ? k : 1, group);
+        for(size_t i=0; i<gamma; i++) {
+            if (!group[i])
+                continue;
+            for(size_t j=0; j<(symmetric ? k : 1); j++)
+                _fmpz_mod_poly_oz_ntt_mul(d, d, self->z_inv[i], self->params->ntt);
+            if (symmetric)
+                break;
+        }
+        status += !fmpz_mod_poly_equal(c, d);
+        gghlite_enc_clear(c);
+        gghlite_enc_clear(d);
+    }
+
+    /* enc(a)·enc(b) - enc(a·b) is an encoding of zero */
+    gghlite_enc_mul(u, self->params, u, v);
+    gghlite_enc_sub(w, self->params, w, u);
+    status += 1 - gghlite_enc_is_zero(self->params, w);
+
+    /* but not of anything else */
+    gghlite_enc_add(w, self->params, w, u);
+    gghlite_enc_add(w, self->params, w, u);
+    status += gghlite_enc_is_zero(self->params, w);
+
+    fmpz_clear(a);
+    fmpz_clear(b);
+    fmpz_clear(ab);
+    fmpz_clear(p);
+    gghlite_enc_clear(u);
+    gghlite_enc_clear(v);
+    gghlite_enc_clear(w);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_z_inv_cache(20, 3, GGHLITE_FLAGS_DEFAULT, randstate);
+    status += test_z_inv_cache(20, 3, GGHLITE_FLAGS_ASYMMETRIC, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}